@@ -0,0 +1,98 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems heap allocation probe code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "allocprobe.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef CUEMS_ALLOC_COUNTING
+
+namespace {
+thread_local bool t_counting = false;
+thread_local uint64_t t_allocs = 0;
+
+void *countedAlloc(std::size_t size)
+{
+    if (t_counting) {
+        ++t_allocs;
+    }
+    return std::malloc(size ? size : 1);
+}
+} // namespace
+
+//////////////////////////////////////////////////////////
+void AllocProbe::begin()
+{
+    t_allocs = 0;
+    t_counting = true;
+}
+
+//////////////////////////////////////////////////////////
+uint64_t AllocProbe::end()
+{
+    t_counting = false;
+    return t_allocs;
+}
+
+//////////////////////////////////////////////////////////
+// Replacement global allocation functions. The aligned overloads are left
+// to the library; nothing on the render path uses over-aligned types.
+void *operator new(std::size_t size)
+{
+    void *p = countedAlloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+#endif // CUEMS_ALLOC_COUNTING
@@ -0,0 +1,56 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems heap allocation probe header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef ALLOCPROBE_H
+#define ALLOCPROBE_H
+
+#include <cstdint>
+
+//////////////////////////////////////////////////////////
+// Counts heap allocations made by the calling thread between begin() and
+// end(). Built with -DCUEMS_ALLOC_COUNTING=ON (CMake), which links
+// allocprobe.cpp and its replacement global operator new; otherwise these
+// are no-ops and cost nothing. Used to check that render ticks do not
+// allocate once warmed up (/stats render_allocs, test/osc_load_test.sh,
+// test/render_alloc_test).
+namespace AllocProbe {
+
+#ifdef CUEMS_ALLOC_COUNTING
+constexpr bool enabled = true;
+void begin();
+uint64_t end();             // allocations since begin()
+#else
+constexpr bool enabled = false;
+inline void begin() {}
+inline uint64_t end() { return 0; }
+#endif
+
+} // namespace AllocProbe
+
+#endif // ALLOCPROBE_H
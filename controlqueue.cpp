@@ -0,0 +1,57 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems render control queue code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "controlqueue.h"
+
+//////////////////////////////////////////////////////////
+bool ControlQueue::push(const ControlCommand &command)
+{
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= CuemsConstants::CONTROL_QUEUE_CAPACITY) {
+        return false;
+    }
+
+    m_ring[head % CuemsConstants::CONTROL_QUEUE_CAPACITY] = command;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+bool ControlQueue::pop(ControlCommand &command)
+{
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    command = m_ring[tail % CuemsConstants::CONTROL_QUEUE_CAPACITY];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,83 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems render control queue header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef CONTROLQUEUE_H
+#define CONTROLQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include "cuems_constants.h"
+
+class PatchTable;
+class DmxSequence;
+
+//////////////////////////////////////////////////////////
+// Commands for the render thread that change universe state (/blackout,
+// per-universe /output_rate, /cancel and /replace, masters, /patch_load,
+// sequences).
+// Only the render thread touches the active universes: the OSC thread
+// queues a command and the render loop applies it at the start of its next
+// tick, so neither side takes a lock on the output.
+struct ControlCommand
+{
+    enum class Type : uint8_t { Blackout, UniverseFpsCap, StopCue, MasterLevel, SubmasterAssign, InstallPatch,
+                              SequenceStart, SequenceStop, SequenceRate };
+
+    Type type = Type::Blackout;
+    uint32_t universe = 0;
+    int value = 0;
+    uint32_t cue = 0;                  // StopCue: tag of the cue firing
+    uint16_t master = 0;               // MasterLevel, SubmasterAssign: 0 is the grand master
+    uint16_t first = 0;                // SubmasterAssign channel range
+    uint16_t count = 0;
+    int fadeMs = 0;                    // MasterLevel
+    PatchTable *patch = nullptr;       // InstallPatch, owned by the OSC thread
+    DmxSequence *sequence = nullptr;   // Sequence*, owned by the OSC thread
+    long int head = 0;                 // SequenceStart: play-head it starts at
+    float rate = 0;                    // SequenceRate
+};
+
+//////////////////////////////////////////////////////////
+// Fixed single-producer, single-consumer (render thread) ring. Pushes from
+// more than one thread (the OSC thread, and main() before run()) must be
+// serialized by the caller, as DmxPlayer::postControl() does. push() fails
+// when the ring is full.
+class ControlQueue
+{
+    public:
+        bool push(const ControlCommand &command);
+        bool pop(ControlCommand &command);
+
+    private:
+        ControlCommand m_ring[CuemsConstants::CONTROL_QUEUE_CAPACITY];
+        std::atomic<uint32_t> m_head{0};   // next slot to write (producer)
+        std::atomic<uint32_t> m_tail{0};   // next slot to read (render thread)
+};
+
+#endif // CONTROLQUEUE_H
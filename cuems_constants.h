@@ -40,10 +40,17 @@ constexpr int MIN_CHANNEL_ID = 0;
 constexpr int MAX_CHANNEL_ID = 512;
 constexpr int MIN_DMX_VALUE = 0;
 constexpr int MAX_DMX_VALUE = 255;
+constexpr int DMX_CHANNELS_PER_UNIVERSE = 512;
 
 // Network related constants
 constexpr int MIN_PORT_NUMBER = 1;
 constexpr int MAX_PORT_NUMBER = 65535;
+constexpr int OSC_REPLY_BUFFER_SIZE = 4096;     // OSC replies (/stats)
+// Batched OSC ingest (OscBatchReceiver): datagrams per recvmmsg() call, the
+// largest datagram accepted and the default socket receive buffer
+constexpr unsigned int OSC_BATCH_SIZE = 32;
+constexpr unsigned int OSC_MAX_DATAGRAM = 65536;
+constexpr int OSC_RCVBUF_DEFAULT = 4 * 1024 * 1024;
 
 // Timing related constants
 constexpr int MILLISECONDS_PER_SECOND = 1000;
@@ -53,6 +60,17 @@ constexpr int MILLISECONDS_PER_HOUR = 60 * MILLISECONDS_PER_MINUTE;
 // OLA callback timeout (ms)
 constexpr int OLA_CALLBACK_TIMEOUT_MS = 10;
 
+// DMX transmit rate cap per universe (frames/s). DMX512 tops out at ~44
+// frames/s with a full universe; 0 disables the cap.
+constexpr int OUTPUT_FPS_DEFAULT = 44;
+constexpr int OUTPUT_FPS_MAX = 1000;
+// Universes that can have a cap of their own (/output_rate <universe>)
+constexpr unsigned int UNIVERSE_FPS_CAPS_MAX = 256;
+// Frames per universe handed to olad and not yet acknowledged. At the cap
+// a universe skips its transmit slots, its buffer keeping only the newest
+// frame, until olad catches up.
+constexpr unsigned int OUTPUT_MAX_IN_FLIGHT = 2;
+
 // Idle polling interval (5x/sec) — reduces CPU when no scenes are active.
 // New scenes trigger an instant switch back to OLA_CALLBACK_TIMEOUT_MS.
 constexpr int OLA_CALLBACK_TIMEOUT_IDLE_MS = 200;
@@ -60,9 +78,93 @@ constexpr int OLA_CALLBACK_TIMEOUT_IDLE_MS = 200;
 // Universe fetch look ahead time (ms)
 constexpr int UNIVERSE_FETCH_LOOK_AHEAD_MS = 50;
 
+// Play-head PLL (PlayHeadTracker) constants
+// Loop bandwidth: settles in ~1 s, well below quarter-frame jitter rates
+constexpr double PLAYHEAD_PLL_BANDWIDTH_HZ = 0.5;
+// Larger raw-vs-predicted errors are discontinuities: re-lock hard
+constexpr double PLAYHEAD_RELOCK_THRESHOLD_MS = 100.0;
+// Re-lock as well after a gap in updates longer than this
+constexpr double PLAYHEAD_MAX_GAP_MS = 1000.0;
+// Max phase correction as a fraction of elapsed time (10%)
+constexpr double PLAYHEAD_MAX_SLEW = 0.1;
+// Tracked rate is limited to 1.0 +/- this (MTC pull-up/down is 0.1%)
+constexpr double PLAYHEAD_MAX_RATE_DEVIATION = 0.05;
+
+// Startup readiness gates (main.cpp)
+constexpr int OLA_RPC_PORT = 9010;                  // olad's default RPC port
+constexpr int STARTUP_GATE_POLL_MS = 100;           // olad RPC port poll interval
+constexpr int STARTUP_GATE_MIDI_TIMEOUT_MS = 250;   // MIDI re-probe without announce events
+constexpr int STARTUP_GATE_LOG_INTERVAL_S = 5;      // "Waiting for ..." log throttle
+
+// Persistent output snapshot: universe slots in the mapped file, and the
+// default location (tmpfs: survives process restarts, not reboots)
+constexpr unsigned int SNAPSHOT_MAX_UNIVERSES = 64;
+constexpr const char* SNAPSHOT_FILE_DEFAULT_DIR = "/dev/shm";
+
+// Show trace (ShowTrace): ring size per writer thread, its limit and the
+// default location (tmpfs, like the snapshot)
+constexpr int TRACE_REGION_MB_DEFAULT = 32;
+constexpr int TRACE_REGION_MB_MAX = 1024;
+constexpr const char* TRACE_FILE_DEFAULT_DIR = "/dev/shm";
+
+// Universe slots preallocated for the render loop (activating a universe
+// never allocates; scenes for more universes wait for a free slot) and the
+// effects each slot has room for up front (more running at once are dropped)
+constexpr unsigned int ACTIVE_UNIVERSE_SLOTS = 64;
+constexpr unsigned int EFFECTS_PER_UNIVERSE_MAX = 32;
+
+// Times given over OSC (effect durations, fade spreads, master fades,
+// sequence steps) are clamped to a day, and effect rates to this many cycles
+// per second, so converting them to integer milliseconds cannot overflow
+constexpr float OSC_TIME_MAX_S = 86400.0f;
+constexpr float EFFECT_RATE_MAX_HZ = 1000.0f;
+
+// Submasters (/submaster), besides the grand master (/master)
+constexpr unsigned int SUBMASTER_COUNT = 32;
+
+// Patch table: logical universes feeding one physical universe
+constexpr unsigned int PATCH_MAX_SOURCES = 8;
+
+// Sequences (/sequence): steps per definition, sequences running at once
+constexpr unsigned int SEQUENCE_MAX_STEPS = 1024;
+constexpr unsigned int SEQUENCE_MAX_RUNNING = 32;
+
+// Scene queue caps (--max-scenes, --max-scene-mb): scenes waiting for
+// their start and the memory they hold; what happens past them is set
+// by --scene-overflow
+constexpr unsigned int SCENE_QUEUE_MAX_SCENES_DEFAULT = 4096;
+constexpr int SCENE_QUEUE_MAX_MB_DEFAULT = 64;
+constexpr int SCENE_QUEUE_MAX_MB_MAX = 4096;
+
+// Control commands (/blackout, per-universe /output_rate, cue stops) queued for the render loop
+constexpr unsigned int CONTROL_QUEUE_CAPACITY = 64;
+
+// Frames and fetches queued from the render thread to the output (I/O)
+// thread, and completions queued back; each way
+constexpr unsigned int OUTPUT_QUEUE_CAPACITY = 256;
+
+// Universes reported by /get_state (published output state)
+constexpr unsigned int STATE_MAX_UNIVERSES = 64;
+
+// Real-time render mode (--rt-priority): stack and heap touched up front
+// so the locked render thread takes no page faults later
+constexpr int RT_PRIORITY_MIN = 1;
+constexpr int RT_PRIORITY_MAX = 99;
+constexpr unsigned int RT_PREFAULT_STACK_BYTES = 256 * 1024;
+constexpr unsigned int RT_PREFAULT_HEAP_BYTES = 8 * 1024 * 1024;
+
+// Deferred render-thread log (RenderLog): ring slots, line length and how
+// often the background thread writes them out
+constexpr unsigned int RENDER_LOG_CAPACITY = 256;
+constexpr unsigned int RENDER_LOG_LINE_SIZE = 160;
+constexpr int RENDER_LOG_DRAIN_MS = 50;
+
 // OLA reconnection constants
 constexpr int OLA_RECONNECT_INITIAL_DELAY_MS = 500;
 constexpr int OLA_RECONNECT_MAX_DELAY_MS = 5000;
+// Scenes whose fade ended longer ago than this are dropped on reconnect;
+// covers one full back-off step so an olad restart loses no cues
+constexpr int OLA_RECONNECT_SCENE_RETENTION_MS = OLA_RECONNECT_MAX_DELAY_MS;
 
 } // namespace CuemsConstants
 
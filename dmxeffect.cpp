@@ -0,0 +1,144 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX parametric effect generator code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "dmxeffect.h"
+#include "cuems_constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sine is sampled from a table so the per-channel loop stays branch-free
+// and the compiler can vectorize it; 1024 steps is far finer than 8 bits.
+constexpr int SINE_TABLE_SIZE = 1024;
+
+// Fraction of the cycle a strobe stays at its high value
+constexpr float STROBE_DUTY = 0.1f;
+
+struct SineTable
+{
+    float values[SINE_TABLE_SIZE];
+    SineTable() {
+        for (int i = 0; i < SINE_TABLE_SIZE; ++i) {
+            values[i] = std::sin(2.0 * M_PI * i / SINE_TABLE_SIZE);
+        }
+    }
+};
+
+const SineTable sineTable;
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+void DmxEffect::render(long int playHead, uint8_t *out) const
+{
+    const unsigned int count = std::min<unsigned int>(m_channelCount,
+        CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+    if (0 == count) {
+        return;
+    }
+
+    // The base phase is reduced in double precision: after hours of show
+    // time (ms * rate) a float would no longer resolve the fraction.
+    double base = (playHead - m_mtcStart) * static_cast<double>(m_rate) / 1000.0;
+    base -= std::floor(base);
+    const float phase0 = static_cast<float>(base);
+    const float step = m_spread / count;
+
+    // Each pass below is a straight loop over the range: phase, waveform,
+    // then scale and clamp. Keeping them separate lets each one vectorize.
+    float w[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+    for (unsigned int i = 0; i < count; ++i) {
+        float p = phase0 + step * i;
+        w[i] = p - std::floor(p);
+    }
+
+    switch (m_waveform) {
+    case Waveform::Sine:
+        for (unsigned int i = 0; i < count; ++i) {
+            int idx = static_cast<int>(w[i] * SINE_TABLE_SIZE) & (SINE_TABLE_SIZE - 1);
+            w[i] = sineTable.values[idx];
+        }
+        break;
+    case Waveform::Square:
+        for (unsigned int i = 0; i < count; ++i) {
+            w[i] = w[i] < 0.5f ? 1.0f : -1.0f;
+        }
+        break;
+    case Waveform::Triangle:
+        for (unsigned int i = 0; i < count; ++i) {
+            w[i] = 1.0f - 4.0f * std::fabs(w[i] - 0.5f);
+        }
+        break;
+    case Waveform::Saw:
+        for (unsigned int i = 0; i < count; ++i) {
+            w[i] = 2.0f * w[i] - 1.0f;
+        }
+        break;
+    case Waveform::Ramp:
+        for (unsigned int i = 0; i < count; ++i) {
+            w[i] = 1.0f - 2.0f * w[i];
+        }
+        break;
+    case Waveform::Strobe:
+        for (unsigned int i = 0; i < count; ++i) {
+            w[i] = w[i] < STROBE_DUTY ? 1.0f : -1.0f;
+        }
+        break;
+    }
+
+    for (unsigned int i = 0; i < count; ++i) {
+        float v = m_offset + m_amplitude * w[i];
+        v = std::min(std::max(v, 0.0f), 255.0f);
+        out[i] = static_cast<uint8_t>(v + 0.5f);
+    }
+}
+
+//////////////////////////////////////////////////////////
+//static
+bool DmxEffect::parseWaveform(std::string_view name, Waveform &waveform)
+{
+    if ("sine" == name) {
+        waveform = Waveform::Sine;
+    } else if ("square" == name) {
+        waveform = Waveform::Square;
+    } else if ("triangle" == name) {
+        waveform = Waveform::Triangle;
+    } else if ("saw" == name) {
+        waveform = Waveform::Saw;
+    } else if ("ramp" == name) {
+        waveform = Waveform::Ramp;
+    } else if ("strobe" == name) {
+        waveform = Waveform::Strobe;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX parametric effect generator header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef DMXEFFECT_H
+#define DMXEFFECT_H
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+//////////////////////////////////////////////////////////
+// A periodic generator attached to a contiguous channel range of one
+// universe. It is evaluated from the play-head on every render tick, so
+// chases, waves and strobes run with render-loop timing instead of being
+// streamed as short-fade bundles.
+//
+// Sample for channel i of the range:
+//   phase = (playHead - m_mtcStart) * m_rate / 1000 + i * m_spread / count
+//   value = clamp(m_offset + m_amplitude * wave(phase), 0, 255)
+// where wave() returns values in [-1, 1].
+struct DmxEffect
+{
+    enum class Waveform : uint8_t { Sine, Square, Triangle, Saw, Ramp, Strobe };
+
+    uint16_t m_firstChannel = 0;
+    uint16_t m_channelCount = 0;
+    Waveform m_waveform = Waveform::Sine;
+    float m_rate = 1.0f;        // Cycles per second
+    float m_spread = 0.0f;      // Phase spread across the whole range, in cycles
+    float m_amplitude = 127.5f; // Peak deviation, in DMX units
+    float m_offset = 127.5f;    // Centre value, in DMX units
+    long int m_mtcStart = 0;    // Phase reference and first rendered time
+    long int m_mtcEnd = std::numeric_limits<long int>::max();
+    uint32_t m_cue = 0;         // Tag of the cue that started it (DmxPlayer), 0 for none
+
+    bool isRunning(long int playHead) const {
+        return playHead >= m_mtcStart && playHead < m_mtcEnd;
+    }
+
+    // Writes m_channelCount samples for the given play-head into out[0..count)
+    void render(long int playHead, uint8_t *out) const;
+
+    // Parse an OSC waveform name ("sine", "square", "triangle", "saw",
+    // "ramp", "strobe"). Returns false on an unknown name.
+    static bool parseWaveform(std::string_view name, Waveform &waveform);
+};
+
+#endif // DMXEFFECT_H
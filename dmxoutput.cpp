@@ -0,0 +1,122 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX output backends code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "dmxoutput.h"
+#include "./cuemslogger/cuemslogger.h"
+
+//////////////////////////////////////////////////////////
+bool OlaDmxOutput::setup(ola::Callback0<void> *onClosed, FrameDoneCallback *onFrameDone)
+{
+    m_onFrameDone.reset(onFrameDone);
+
+    // auto_start=false: connect only to an already-running olad; never fork a
+    // rogue `olad` (which would run as cuems without plugdev and be unable to
+    // drive USB DMX widgets). main() has already gated on olad reachability.
+    m_wrapper = std::make_unique<ola::client::OlaClientWrapper>(false);
+
+    if (!m_wrapper->Setup()) {
+        CuemsLogger::getLogger()->logError("OLA setup failed");
+        m_wrapper.reset();
+        delete onClosed;
+        return false;
+    }
+
+    if (m_wrapper->GetSelectServer() == nullptr) {
+        CuemsLogger::getLogger()->logError("OLA SelectServer is null");
+        m_wrapper.reset();
+        delete onClosed;
+        return false;
+    }
+
+    // Override the default close behavior (which just calls Terminate).
+    m_wrapper->SetCloseCallback(onClosed);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+ola::io::SelectServer *OlaDmxOutput::selectServer()
+{
+    return m_wrapper ? m_wrapper->GetSelectServer() : nullptr;
+}
+
+//////////////////////////////////////////////////////////
+void OlaDmxOutput::sendDmx(uint32_t universe, const ola::DmxBuffer &buffer)
+{
+    ola::client::SendDMXArgs args(ola::NewSingleCallback(this, &OlaDmxOutput::frameDone, universe));
+    m_wrapper->GetClient()->SendDMX(universe, buffer, args);
+}
+
+//////////////////////////////////////////////////////////
+void OlaDmxOutput::frameDone(uint32_t universe, const ola::client::Result &result)
+{
+    if (m_onFrameDone) {
+        m_onFrameDone->Run(universe, result.Success());
+    }
+}
+
+//////////////////////////////////////////////////////////
+void OlaDmxOutput::fetchDmx(uint32_t universe, ola::client::DMXCallback *callback)
+{
+    m_wrapper->GetClient()->FetchDMX(universe, callback);
+}
+
+//////////////////////////////////////////////////////////
+bool NullDmxOutput::setup(ola::Callback0<void> *onClosed, FrameDoneCallback *onFrameDone)
+{
+    m_onClosed.reset(onClosed);
+    m_onFrameDone.reset(onFrameDone);
+    CuemsLogger::getLogger()->logWarning("DMX output disabled (null backend): frames are discarded");
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void NullDmxOutput::sendDmx(uint32_t universe, const ola::DmxBuffer & /*buffer*/)
+{
+    m_framesSent.fetch_add(1, std::memory_order_relaxed);
+    if (m_onFrameDone) {
+        m_onFrameDone->Run(universe, true);
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Answered on the next SelectServer pass, like an OLA reply: processScenes()
+// expects the universe to stay in the fetching state until then.
+void NullDmxOutput::fetchDmx(uint32_t universe, ola::client::DMXCallback *callback)
+{
+    m_server.Execute(ola::NewSingleCallback(this, &NullDmxOutput::completeFetch, universe, callback));
+}
+
+//////////////////////////////////////////////////////////
+void NullDmxOutput::completeFetch(uint32_t universe, ola::client::DMXCallback *callback)
+{
+    ola::DmxBuffer buffer;
+    buffer.Blackout();
+    callback->Run(ola::client::Result(""), ola::client::DMXMetadata(universe), buffer);
+}
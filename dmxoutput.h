@@ -0,0 +1,116 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX output backends header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef DMXOUTPUT_H
+#define DMXOUTPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ola/DmxBuffer.h>
+#include <ola/Callback.h>
+#include <ola/client/ClientWrapper.h>
+#include <ola/io/SelectServer.h>
+
+//////////////////////////////////////////////////////////
+// Where rendered universes go. The backend also owns the SelectServer that
+// drives the render timer, so DmxPlayer runs the same way on either one.
+//
+// setup() takes ownership of onClosed, which the backend runs (from its
+// SelectServer thread) when the output connection is lost, and of
+// onFrameDone, run (on the same thread) for every frame given to sendDmx()
+// once the output has taken it: (universe, ok), ok false if it was
+// rejected or lost. The player counts the frames still in flight with it.
+class DmxOutput
+{
+    public:
+        using FrameDoneCallback = ola::Callback2<void, uint32_t, bool>;
+
+        virtual ~DmxOutput() = default;
+
+        virtual bool setup(ola::Callback0<void> *onClosed, FrameDoneCallback *onFrameDone) = 0;
+        virtual ola::io::SelectServer *selectServer() = 0;
+
+        virtual void sendDmx(uint32_t universe, const ola::DmxBuffer &buffer) = 0;
+        virtual void fetchDmx(uint32_t universe, ola::client::DMXCallback *callback) = 0;
+
+        virtual const char *name() const = 0;
+};
+
+//////////////////////////////////////////////////////////
+// olad through the OLA client library. Frames go out as acknowledged
+// UpdateDmxData RPCs (SendDMX with a completion callback) rather than
+// unacknowledged streaming, so a busy olad shows up as frames in flight.
+class OlaDmxOutput : public DmxOutput
+{
+    public:
+        bool setup(ola::Callback0<void> *onClosed, FrameDoneCallback *onFrameDone) override;
+        ola::io::SelectServer *selectServer() override;
+
+        void sendDmx(uint32_t universe, const ola::DmxBuffer &buffer) override;
+        void fetchDmx(uint32_t universe, ola::client::DMXCallback *callback) override;
+
+        const char *name() const override { return "olad"; }
+
+    private:
+        void frameDone(uint32_t universe, const ola::client::Result &result);
+
+        // Declared first so it outlives the client, which may complete
+        // pending sends while it is destroyed
+        std::unique_ptr<FrameDoneCallback> m_onFrameDone;
+        std::unique_ptr<ola::client::OlaClientWrapper> m_wrapper;
+};
+
+//////////////////////////////////////////////////////////
+// Discards frames, completing each at once, and answers fetches with a
+// blacked-out universe. Lets the player run without olad, for load tests
+// and benchmarks.
+class NullDmxOutput : public DmxOutput
+{
+    public:
+        bool setup(ola::Callback0<void> *onClosed, FrameDoneCallback *onFrameDone) override;
+        ola::io::SelectServer *selectServer() override { return &m_server; }
+
+        void sendDmx(uint32_t universe, const ola::DmxBuffer &buffer) override;
+        void fetchDmx(uint32_t universe, ola::client::DMXCallback *callback) override;
+
+        const char *name() const override { return "null"; }
+
+        uint64_t framesSent() const { return m_framesSent.load(std::memory_order_relaxed); }
+
+    private:
+        void completeFetch(uint32_t universe, ola::client::DMXCallback *callback);
+
+        ola::io::SelectServer m_server;
+        std::unique_ptr<ola::Callback0<void>> m_onClosed;  // never lost, kept for ownership
+        std::unique_ptr<FrameDoneCallback> m_onFrameDone;
+        std::atomic<uint64_t> m_framesSent{0};
+};
+
+#endif // DMXOUTPUT_H
@@ -32,6 +32,21 @@
 #include "cuems_constants.h"
 #include <thread>
 #include <charconv>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <cerrno>
+#include <cstring>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/ip/UdpSocket.h>
 
 using namespace std;
 
@@ -44,10 +59,13 @@ DmxPlayer::DmxPlayer(   int port,
                         const string oscRoute,
                         const bool stopOnLostFlag,
                         const bool followMTCFlag,
-                        const std::string &client_name)
+                        const std::string &client_name,
+                        const bool batchedOsc,
+                        const int oscRcvBufBytes,
+                        const bool mtcInput)
                         :   // Members initialization
-                        OscReceiver(port, oscRoute),
-                        mtcReceiver(MTCRECV_DEFAULT_API, client_name),
+                        OscReceiver(batchedOsc ? 0 : port, oscRoute),
+                        mtcReceiver(mtcInput ? std::make_unique<MtcReceiver>(MTCRECV_DEFAULT_API, client_name) : nullptr),
                         stopOnMTCLost(stopOnLostFlag),
                         followMTC(followMTCFlag)
 {
@@ -55,76 +73,1617 @@ DmxPlayer::DmxPlayer(   int port,
     // Set up working class members
 
     // Enable network-tolerant MTC timeouts (for rtpmidid / MTC over network)
-    mtcReceiver.setNetworkMode(true);
+    if (mtcReceiver) {
+        mtcReceiver->setNetworkMode(true);
+    }
+
+    m_runningSequences.reserve(CuemsConstants::SEQUENCE_MAX_RUNNING);
+
+    // Starting OLA logging
+    ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+
+    // Wakes the output (I/O) thread for the frames the render thread queues
+    m_outputWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_outputWakeFd < 0) {
+        throw std::runtime_error(std::string("Output eventfd: ") + std::strerror(errno));
+    }
+
+    // OLA connection is established (with retry) in run(). Readiness is already
+    // gated in main(), which waits for olad to be reachable before constructing
+    // us — so no redundant fail-fast probe is needed here. (A probe here would
+    // also exit() on a transient olad blip, bypassing main's catch.)
+
+    // Started last: packets are dispatched to our overrides straight away.
+    // A failure is not thrown: unwinding through the OscReceiver base can
+    // deadlock in ~OscReceiver, so main() checks isOscListening() instead.
+    if (batchedOsc) {
+        try {
+            m_batchReceiver = std::make_unique<OscBatchReceiver>(port, oscRcvBufBytes, this);
+        } catch ( const std::exception &e ) {
+            CuemsLogger::getLogger()->logError(std::string("OSC batched receiver failed: ") + e.what());
+            m_oscListening = false;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+DmxPlayer::~DmxPlayer( void ) {
+    // Stop ingest and rendering before the members they use go away
+    m_batchReceiver.reset();
+    stopRenderThread();
+    if (0 <= m_outputWakeFd) {
+        close(m_outputWakeFd);
+    }
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::setOutputLatencyMs(long ms) {
+    if (ms < 0) ms = 0;
+    if (ms > 500) ms = 500;
+    m_outputLatencyMs.store(ms);
+    CuemsLogger::getLogger()->logInfo(
+        "DMX output latency compensation updated to "
+        + std::to_string(ms) + " ms");
+}
+
+//////////////////////////////////////////////////////////
+bool DmxPlayer::setSnapshotFile(const std::string &path) {
+    m_snapshotRestorePending = m_snapshot.open(path);
+    return m_snapshotRestorePending;
+}
+
+//////////////////////////////////////////////////////////
+// Tables older than the installed one are no longer seen by the render
+// thread, so they are freed here before the new one is queued
+bool DmxPlayer::setPatchFile(const std::string &path) {
+    auto table = std::make_unique<PatchTable>();
+    if (!table->load(path)) {
+        CuemsLogger::getLogger()->logWarning("Patch: " + table->lastError() + ", patch not changed");
+        return false;
+    }
+
+    std::lock_guard guard(m_patchMutex);
+    PatchTable *installed = m_patchInstalled.load(std::memory_order_acquire);
+    auto current = std::find_if(m_patchTables.begin(), m_patchTables.end(),
+        [installed](const std::unique_ptr<PatchTable> &t) { return t.get() == installed; });
+    if (current != m_patchTables.end()) {
+        m_patchTables.erase(m_patchTables.begin(), current);
+    }
+
+    ControlCommand command;
+    command.type = ControlCommand::Type::InstallPatch;
+    command.patch = table.get();
+    if (!postControl(command)) {
+        return false;
+    }
+    CuemsLogger::getLogger()->logInfo("Patch: " + std::to_string(table->entries()) + " route(s) to "
+        + std::to_string(table->physical().size()) + " physical universe(s) from " + path);
+    m_patchTables.push_back(std::move(table));
+    m_patchPath = path;
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+bool DmxPlayer::setTraceFile(const std::string &path, size_t regionBytes) {
+    if (!m_trace.open(path, regionBytes)) {
+        CuemsLogger::getLogger()->logWarning("Trace: " + m_trace.lastError());
+        return false;
+    }
+    CuemsLogger::getLogger()->logInfo("Trace: recording to " + path);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::setOutputFpsCap(int fps) {
+    fps = std::clamp(fps, 0, CuemsConstants::OUTPUT_FPS_MAX);
+    m_outputFpsCap.store(fps);
+    CuemsLogger::getLogger()->logInfo(
+        "DMX output rate cap updated to " + std::to_string(fps) + " fps");
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::setSceneQueueLimits(size_t maxScenes, size_t maxBytes, SceneOverflow policy) {
+    {
+        std::lock_guard guard(m_scenesMutex);
+        m_maxQueuedScenes = maxScenes;
+        m_maxQueuedSceneBytes = maxBytes;
+        m_sceneOverflow = policy;
+    }
+    CuemsLogger::getLogger()->logInfo(
+        "Scene queue limits: " + std::to_string(maxScenes) + " scenes, "
+        + std::to_string(maxBytes) + " bytes (0 = no limit)");
+}
+
+//////////////////////////////////////////////////////////
+bool DmxPlayer::parseSceneOverflow(const std::string &name, SceneOverflow &policy) {
+    if ("reject" == name) {
+        policy = SceneOverflow::Reject;
+    } else if ("drop-oldest" == name) {
+        policy = SceneOverflow::DropOldest;
+    } else if ("coalesce" == name) {
+        policy = SceneOverflow::Coalesce;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::setOutputFpsCap(uint32_t univ_id, int fps) {
+    fps = std::clamp(fps, 0, CuemsConstants::OUTPUT_FPS_MAX);
+    ControlCommand command;
+    command.type = ControlCommand::Type::UniverseFpsCap;
+    command.universe = univ_id;
+    command.value = fps;
+    if (!postControl(command)) {
+        return;
+    }
+    CuemsLogger::getLogger()->logInfo(
+        "DMX output rate cap for universe " + std::to_string(univ_id)
+        + " updated to " + std::to_string(fps) + " fps");
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::setMasterLevel(unsigned int master, float level, float fadeSeconds) {
+    if (!std::isfinite(level) || !std::isfinite(fadeSeconds) || fadeSeconds < 0) {
+        CuemsLogger::getLogger()->logWarning("OSC: Invalid master level or fade time");
+        return;
+    }
+    ControlCommand command;
+    command.type = ControlCommand::Type::MasterLevel;
+    command.master = master;
+    command.value = OutputMasters::fromFloat(level);
+    command.fadeMs = std::round(1000 * std::min(fadeSeconds, CuemsConstants::OSC_TIME_MAX_S));
+    if (!postControl(command)) {
+        return;
+    }
+    CuemsLogger::getLogger()->logInfo(
+        (0 == master ? std::string("Grand master") : "Submaster " + std::to_string(master))
+        + " to " + std::to_string(level) + " in " + std::to_string(fadeSeconds) + " s");
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::assignSubmaster(unsigned int sub, uint32_t univ_id, int first, int count, bool on) {
+    ControlCommand command;
+    command.type = ControlCommand::Type::SubmasterAssign;
+    command.master = sub;
+    command.universe = univ_id;
+    command.first = first;
+    command.count = count;
+    command.value = on ? 1 : 0;
+    postControl(command);
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint)
+{
+  if (m_trace.isOpen()) {
+    int64_t nowUs = chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    m_trace.record(ShowTrace::Region::Ingest, ShowTrace::Type::Packet, nowUs, data, size);
+  }
+  OscReceiver::ProcessPacket(data, size, remoteEndpoint);
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::ProcessBundle( const osc::ReceivedBundle& b,
+                               const IpEndpointName& remoteEndpoint )
+{
+  // set 'now' MTC by default if it's a top-leven bundle;
+  if (0 == m_inBundle) {
+    m_nextScene.m_mtcStart = stampHead(m_nextScene.m_internalClock);
+    m_nextScene.m_timed = false;
+    m_nextScene.m_cueId.clear();
+    m_nextScene.m_cueTag = 0;
+    m_nextScene.m_replace = false;
+    m_nextSequence.reset();
+  }
+  ++m_inBundle;
+  std::cout << "DmxPlayer::ProcessBundle => " << m_inBundle
+    << " thread=" << std::this_thread::get_id()
+    << std::endl;
+  OscReceiver::ProcessBundle(b, remoteEndpoint);
+  --m_inBundle;
+  std::cout << "DmxPlayer::ProcessBundle <= " << m_inBundle
+    << "  values:" << m_nextScene.m_channels.size() << std::endl;
+
+  // If it's a top-level bundle, add m_nextScene to scenes
+  if (0 == m_inBundle) {
+    m_ingestBundles.fetch_add(1, std::memory_order_relaxed);
+    if (m_nextSequence) {
+      // A /sequence bundle only defines the sequence
+      defineSequence();
+      m_nextScene.m_channels.clear();
+      m_nextScene.m_effects.clear();
+      m_nextScene.m_effectStops.clear();
+      m_nextScene.m_fans.clear();
+      return;
+    }
+    // Sorting and span building happen here, on the OSC thread, so the
+    // render thread only ever sweeps compiled scenes
+    m_nextScene.compile();
+    uint32_t stopTag = 0;
+    int dropped = 0;
+    size_t queuedScenes = 0;
+    size_t queuedBytes = 0;
+    std::string replyCueId;
+    Admission admission;
+    const long int sceneStart = m_nextScene.m_mtcStart;
+    int pruned = 0;
+    bool merged = false;
+    bool full = false;
+    size_t fullScenes = 0;
+    size_t fullBytes = 0;
+    {
+      std::lock_guard guard(m_scenesMutex);
+      fullScenes = m_scenes.size();
+      fullBytes = m_queuedSceneBytes;
+      admission = admitScene(m_nextScene, dropped, pruned, full);
+      if (Admission::Fits != admission) {
+        replyCueId = m_nextScene.m_cueId;
+      }
+      merged = Admission::Coalesced == admission;
+      if (Admission::Fits == admission || Admission::DroppedOldest == admission) {
+        if (m_nextScene.m_cueId.empty()) {
+          merged = insertScene(std::move(m_nextScene), pruned) == m_scenes.end();
+        }
+        else {
+          std::string cueId = m_nextScene.m_cueId;
+          stopTag = fireCue(m_nextScene);
+          CueEntry &cue = m_cues[cueId];
+          cue.tag = m_nextScene.m_cueTag;
+          cue.scene = insertScene(std::move(m_nextScene), pruned);
+          cue.queued = true;
+        }
+      }
+      queuedScenes = m_scenes.size();
+      queuedBytes = m_queuedSceneBytes;
+      clearRetiredScenes();
+      countPendingScenes();
+    }
+    if (full) {
+      CuemsLogger::getLogger()->logWarning("Scene queue full: " + std::to_string(fullScenes) + " scenes, "
+          + std::to_string(fullBytes) + " bytes");
+    }
+    if (merged) {
+      CuemsLogger::getLogger()->logDebug("Scene at " + std::to_string(sceneStart) + " coalesced, "
+          + std::to_string(pruned) + " superseded targets dropped");
+    }
+    else if (0 < pruned) {
+      CuemsLogger::getLogger()->logDebug("Scene at " + std::to_string(sceneStart) + ": "
+          + std::to_string(pruned) + " superseded targets dropped");
+    }
+    if (Admission::Fits != admission) {
+      sendSceneQueueReply(admission, dropped, queuedScenes, queuedBytes, replyCueId, remoteEndpoint);
+      if (Admission::Rejected == admission) {
+        m_nextScene.m_channels.clear();
+        m_nextScene.m_spans.clear();
+        m_nextScene.m_effects.clear();
+        m_nextScene.m_effectStops.clear();
+        return;
+      }
+    }
+    // /replace: what the previous firing started stops on the next tick;
+    // the new one has its own tag, so the order does not matter
+    if (0 != stopTag) {
+      ControlCommand command;
+      command.type = ControlCommand::Type::StopCue;
+      command.cue = stopTag;
+      postControl(command);
+    }
+
+    // An idle render loop starts ticking at the active rate now
+    wakeRender();
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Queue a command for the render loop and wake it up if it is idling, so
+// it takes effect within one active tick
+bool DmxPlayer::postControl(const ControlCommand &command)
+{
+  bool queued;
+  {
+    std::lock_guard guard(m_controlPushMutex);
+    queued = m_controlQueue.push(command);
+  }
+  if (!queued) {
+    CuemsLogger::getLogger()->logWarning("Render control queue full, command dropped");
+    return false;
+  }
+  wakeRender();
+  return true;
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: a universe's own cap, kept sorted; when the table is full
+// the cap is not kept and the universe stays on the global one
+void DmxPlayer::setUniverseFpsCap(uint32_t universe, int fps)
+{
+  auto end = m_universeFpsCaps.begin() + m_universeFpsCapCount;
+  auto it = std::lower_bound(m_universeFpsCaps.begin(), end, universe,
+      [](const UniverseFpsCap &cap, uint32_t id) { return cap.universe < id; });
+  if (it != end && it->universe == universe) {
+    it->fps = fps;
+    return;
+  }
+  if (m_universeFpsCapCount == m_universeFpsCaps.size()) {
+    m_renderLog.post(RenderLog::Level::Warning, "%zu universes already have a rate cap, universe %u keeps the global one",
+        m_universeFpsCaps.size(), universe);
+    return;
+  }
+  std::move_backward(it, end, end + 1);
+  *it = {universe, fps};
+  ++m_universeFpsCapCount;
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: the transmit cap of a universe, its own or the global one
+int DmxPlayer::universeFpsCap(uint32_t universe) const
+{
+  auto end = m_universeFpsCaps.begin() + m_universeFpsCapCount;
+  auto it = std::lower_bound(m_universeFpsCaps.begin(), end, universe,
+      [](const UniverseFpsCap &cap, uint32_t id) { return cap.universe < id; });
+  return (it != end && it->universe == universe) ? it->fps : m_outputFpsCap.load();
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: apply the queued commands before the tick renders. A
+// /blackout whose command did not fit in the queue is applied after the
+// queued ones; a command for a blackout already applied that way is skipped.
+void DmxPlayer::applyControlCommands()
+{
+  ControlCommand command;
+  while (m_controlQueue.pop(command)) {
+    switch (command.type) {
+      case ControlCommand::Type::Blackout:
+        if (0 < int32_t(uint32_t(command.value) - m_blackoutsApplied)) {
+          m_blackoutsApplied = uint32_t(command.value);
+          blackoutUniverses();
+        }
+        break;
+      case ControlCommand::Type::UniverseFpsCap:
+        setUniverseFpsCap(command.universe, command.value);
+        break;
+      case ControlCommand::Type::StopCue:
+        stopCue(command.cue);
+        break;
+      case ControlCommand::Type::MasterLevel:
+        m_masters.setLevel(command.master, command.value, int64_t(command.fadeMs) * 1000, m_renderNowUs);
+        m_mastersChanged = true;
+        break;
+      case ControlCommand::Type::SubmasterAssign:
+        m_masters.assign(command.master, command.universe, command.first, command.count, 0 != command.value);
+        m_mastersChanged = true;
+        break;
+      case ControlCommand::Type::InstallPatch:
+        installPatch(command.patch);
+        break;
+      case ControlCommand::Type::SequenceStart:
+        startSequence(command.sequence, command.head, command.value);
+        command.sequence->m_commandsApplied.fetch_add(1, std::memory_order_release);
+        break;
+      case ControlCommand::Type::SequenceStop:
+        stopSequence(command.sequence);
+        command.sequence->m_commandsApplied.fetch_add(1, std::memory_order_release);
+        break;
+      case ControlCommand::Type::SequenceRate:
+        command.sequence->setRate(playHead, command.rate, command.sequence->m_running.load(std::memory_order_relaxed));
+        command.sequence->m_commandsApplied.fetch_add(1, std::memory_order_release);
+        break;
+    }
+  }
+  uint32_t blackouts = m_blackoutRequests.load(std::memory_order_acquire);
+  if (blackouts != m_blackoutsApplied) {
+    m_blackoutsApplied = blackouts;
+    blackoutUniverses();
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: switch to a new patch table. It takes the logical frames
+// the old one had and those of the rendered universes, so every physical
+// universe with a known source is rebuilt under the new routing on this
+// tick. Physical universes the new table drops keep their last frame.
+void DmxPlayer::installPatch(PatchTable *table)
+{
+  if (m_patch != nullptr) {
+    table->adopt(*m_patch);
+  }
+  for (auto *univ : m_activeUniverses) {
+    if (2 == univ->m_state) {
+      table->storeFrame(univ->m_id, univ->m_channelsBuffer.GetRaw(), univ->m_channelsBuffer.Size());
+    }
+  }
+  m_patch = table;
+  m_patchInstalled.store(table, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////
+// Send zeros for every active universe and drop them. The snapshot and the
+// /get_state output are blacked out too, so a restart does not bring the
+// old look back. A universe whose zeros cannot be queued now (output queue
+// full, or olad down) stays active with nothing running on it: its frame
+// goes out on the next transmit slot, or on reconnect, and it retires then.
+void DmxPlayer::blackoutUniverses()
+{
+  for (auto *seq : m_runningSequences) {
+    for (auto &track : seq->tracks()) {
+      track.attached = false;
+    }
+    seq->m_running.store(false, std::memory_order_release);
+  }
+  m_runningSequences.clear();
+  for (size_t index = 0; index < m_activeUniverses.size();) {
+    auto &univ = m_activeUniverses.at(index);
+    univ.m_channelTransitions.clear();
+    univ.m_effects.clear();
+    univ.m_sequences = 0;
+    univ.m_channelsBuffer.Blackout();
+    m_snapshot.publish(univ.m_id, playHead, univ.m_channelsBuffer.GetRaw(), univ.m_channelsBuffer.Size(),
+      [](OutputSnapshot::Transition *, size_t) { return size_t(0); });
+    if (m_olaConnected && sendFrame(univ)) {
+      m_snapshot.release(univ.m_id);
+      m_snapshotFullWarned = false;
+      m_activeUniverses.releaseAt(index);
+    }
+    else {
+      univ.m_state = 2;         // a fetch still in flight must not bring the old values back
+      univ.m_dirty = true;
+      univ.m_nextTxUs = 0;
+      ++index;
+    }
+  }
+  m_universeSlotsFull = false;
+  if (m_patch != nullptr) {
+    m_patch->blackout();      // sent at the end of the tick
+  }
+
+  for (uint32_t i = 0; i < m_renderState.universeCount; ++i) {
+    auto &entry = m_renderState.universes[i];
+    std::fill(std::begin(entry.values), std::end(entry.values), 0);
+    entry.fades = 0;
+    entry.effects = 0;
+  }
+  publishState();
+}
+
+//////////////////////////////////////////////////////////
+// Hand one universe frame to the output, through the masters. A patched
+// logical universe is only stored: its physical universes go out in
+// sendPatchFrames(). Universes the patch sends to are not sent directly.
+// False if the frame could not be queued (see transmit()).
+bool DmxPlayer::sendFrame(ActiveUniverse &univ)
+{
+  if (m_patch != nullptr && !m_patch->isLogical(univ.m_id) && m_patch->isPhysical(univ.m_id)) {
+    return true;
+  }
+  m_outputUniverses[univ.m_id / 64] |= uint64_t(1) << (univ.m_id % 64);
+  if (m_patch != nullptr
+      && m_patch->storeFrame(univ.m_id, univ.m_channelsBuffer.GetRaw(), univ.m_channelsBuffer.Size())) {
+    return true;
+  }
+
+  const ola::DmxBuffer *frame = &univ.m_channelsBuffer;
+  if (!m_masters.isFull(univ.m_id)) {
+    uint8_t scaled[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+    unsigned int size = std::min<unsigned int>(univ.m_channelsBuffer.Size(),
+                                               CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+    m_masters.apply(univ.m_id, univ.m_channelsBuffer.GetRaw(), scaled, size);
+    univ.m_outputBuffer.Set(scaled, size);
+    frame = &univ.m_outputBuffer;
+  }
+
+  if (!transmit(univ.m_id, *frame)) {
+    return false;
+  }
+  ++univ.m_inFlight;
+  return true;
+}
+
+//////////////////////////////////////////////////////////
+// Queue one frame for the I/O thread, which sends it when it is woken at
+// the end of the tick; traced, and hashed under --replay. When the queue
+// is full (the I/O thread is stuck) nothing is counted and the caller
+// holds the frame back, like at the in-flight cap.
+bool DmxPlayer::transmit(uint32_t universe, const ola::DmxBuffer &frame)
+{
+  const uint8_t *raw = frame.GetRaw();
+  unsigned int size = std::min<unsigned int>(frame.Size(), CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+  OutputMessage request;
+  request.type = OutputMessage::Type::Frame;
+  request.universe = universe;
+  request.generation = m_renderGeneration;
+  request.size = size;
+  std::memcpy(request.data, raw, size);
+  if (!m_outputRequests.push(request)) {
+    m_framesCoalesced.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_outputRequested = true;
+
+  uint32_t inFlight = m_outputInFlight.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (inFlight > m_outputInFlightPeak.load(std::memory_order_relaxed)) {
+    m_outputInFlightPeak.store(inFlight, std::memory_order_relaxed);
+  }
+  m_framesSent.fetch_add(1, std::memory_order_relaxed);
+
+  m_trace.record(ShowTrace::Region::Render, ShowTrace::Type::Frame, m_renderNowUs,
+                 &universe, sizeof(universe), raw, size);
+  if (m_replay) {
+    ++m_replayFrames;
+    m_replayHash = ShowTrace::frameHash(m_replayHash, universe, raw, size);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////
+// Rebuild and send the physical universes whose sources changed. Each
+// source frame goes through its (logical) universe's masters into the
+// staging area, then one gather pass builds the physical frame. The
+// in-flight cap applies as for direct universes: a held-back universe
+// stays dirty and goes out with its newest sources.
+void DmxPlayer::sendPatchFrames()
+{
+  m_patchPending = false;
+  if (m_patch == nullptr || !m_olaConnected) {
+    return;
+  }
+  constexpr size_t CHANNELS = PatchTable::CHANNELS;
+  uint8_t staging[PatchTable::STAGING_SIZE];
+  uint8_t out[CHANNELS];
+  staging[PatchTable::UNPATCHED] = 0;
+  for (auto &phys : m_patch->physical()) {
+    if (!phys.dirty) {
+      continue;
+    }
+    if (CuemsConstants::OUTPUT_MAX_IN_FLIGHT <= phys.inFlight) {
+      m_framesCoalesced.fetch_add(1, std::memory_order_relaxed);
+      m_patchPending = true;
+      continue;
+    }
+    for (unsigned int s = 0; s < phys.sourceCount; ++s) {
+      uint32_t source = phys.sources[s];
+      uint32_t universe = m_patch->sourceUniverse(source);
+      if (m_masters.isFull(universe)) {
+        std::memcpy(staging + s * CHANNELS, m_patch->sourceFrame(source), CHANNELS);
+      }
+      else {
+        m_masters.apply(universe, m_patch->sourceFrame(source), staging + s * CHANNELS, CHANNELS);
+      }
+    }
+    PatchTable::gather(phys, staging, out);
+    phys.buffer.Set(out, CHANNELS);
+    if (!transmit(phys.universe, phys.buffer)) {
+      m_patchPending = true;
+      continue;
+    }
+    phys.dirty = false;
+    ++phys.inFlight;
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: wake the I/O thread for the requests of this tick, with
+// one write however many there are
+void DmxPlayer::flushOutputRequests()
+{
+  if (!m_outputRequested) {
+    return;
+  }
+  m_outputRequested = false;
+  uint64_t one = 1;
+  // Only fails with the counter saturated, i.e. a wake-up already pending
+  [[maybe_unused]] ssize_t written = write(m_outputWakeFd, &one, sizeof(one));
+}
+
+//////////////////////////////////////////////////////////
+// Render thread, at the start of a tick: pick up a new output connection,
+// then take what the I/O thread reported since the previous tick
+void DmxPlayer::applyOutputEvents()
+{
+  uint32_t generation = m_outputGeneration.load(std::memory_order_acquire);
+  if (generation != m_renderGeneration) {
+    m_renderGeneration = generation;
+    // Keep fades running across the reconnect, re-fetch what was pending
+    resumeAfterReconnect();
+    // First connection: resume the output of the previous run
+    if (m_snapshotRestorePending) {
+      restoreSnapshot();
+    }
+  }
+
+  OutputMessage event;
+  while (m_outputEvents.pop(event)) {
+    if (event.generation != m_renderGeneration) {
+      continue;       // from a lost connection: its counts were reset
+    }
+    if (OutputMessage::Type::FrameDone == event.type) {
+      frameDone(event.universe, event.ok);
+    }
+    else {
+      universeFetched(event);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: the output took (or lost) one frame. Completions for
+// universes retired meanwhile only settle the total.
+void DmxPlayer::frameDone(uint32_t universe, bool ok)
+{
+  if (auto *phys = (m_patch != nullptr) ? m_patch->findPhysical(universe) : nullptr) {
+    if (0 < phys->inFlight) {
+      --phys->inFlight;
+    }
+  }
+  else if (auto *univ = m_activeUniverses.find(universe)) {
+    if (0 < univ->m_inFlight) {
+      --univ->m_inFlight;
+    }
+  }
+  if (0 < m_outputInFlight.load(std::memory_order_relaxed)) {
+    m_outputInFlight.fetch_sub(1, std::memory_order_relaxed);
+  }
+  if (!ok) {
+    m_sendFailures.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: a FetchDMX reply, for a universe still waiting for one
+// (a blackout may have set it meanwhile). Set() copies into the slot's own
+// storage.
+void DmxPlayer::universeFetched(const OutputMessage &event)
+{
+  m_renderLog.post(RenderLog::Level::Debug, "Universe %u fetched: result=%d buffer size=%u",
+      event.universe, event.ok ? 1 : 0, static_cast<unsigned>(event.size));
+  auto *univ = m_activeUniverses.find(event.universe);
+  if (univ != nullptr && 1 == univ->m_state) {
+    if (event.ok) {
+      univ->m_state = 2;
+      univ->m_channelsBuffer.Set(event.data, event.size);
+    }
+    else {
+      univ->m_state = 3;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////
+// I/O thread, woken by flushOutputRequests(): send the frames and start
+// the fetches the render thread queued. Requests made before the current
+// connection are dropped.
+void DmxPlayer::onOutputRequests()
+{
+  uint64_t count = 0;
+  [[maybe_unused]] ssize_t got = read(m_outputWakeFd, &count, sizeof(count));
+
+  uint32_t generation = m_outputGeneration.load(std::memory_order_relaxed);
+  OutputMessage request;
+  while (m_outputRequests.pop(request)) {
+    if (request.generation != generation) {
+      continue;
+    }
+    if (OutputMessage::Type::Frame == request.type) {
+      m_ioBuffer.Set(request.data, request.size);
+      m_output->sendDmx(request.universe, m_ioBuffer);
+    }
+    else {
+      m_output->fetchDmx(request.universe,
+          ola::NewSingleCallback(&DmxPlayer::OnFetchDMX, this, request.universe));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////
+// I/O thread: the output took (or lost) one frame
+void DmxPlayer::onFrameDone(uint32_t universe, bool ok)
+{
+  OutputMessage event{};
+  event.type = OutputMessage::Type::FrameDone;
+  event.universe = universe;
+  event.generation = m_outputGeneration.load(std::memory_order_relaxed);
+  event.ok = ok;
+  postOutputEvent(event);
+}
+
+//////////////////////////////////////////////////////////
+// I/O thread: report to the render thread. It drains the queue every
+// tick, so the queue only fills if it stalls; events then wait here, in
+// order, and are retried on a timer rather than lost (a lost completion
+// would hold its universe at the in-flight cap).
+void DmxPlayer::postOutputEvent(const OutputMessage &event)
+{
+  if (m_ioBacklog.empty() && m_outputEvents.push(event)) {
+    return;
+  }
+  m_ioBacklog.push_back(event);
+  if (!m_ioRetryPending) {
+    retryOutputEvents();
+  }
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::retryOutputEvents()
+{
+  m_ioRetryPending = false;
+  size_t posted = 0;
+  while (posted < m_ioBacklog.size() && m_outputEvents.push(m_ioBacklog[posted])) {
+    ++posted;
+  }
+  m_ioBacklog.erase(m_ioBacklog.begin(), m_ioBacklog.begin() + posted);
+  if (!m_ioBacklog.empty() && olaServer != nullptr) {
+    m_ioRetryPending = true;
+    olaServer->RegisterSingleTimeout(CuemsConstants::OLA_CALLBACK_TIMEOUT_MS,
+        ola::NewSingleCallback(this, &DmxPlayer::retryOutputEvents));
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Written after the tick's frames, stamped with its start time: dmxreplay
+// groups the frames before a tick record with that tick
+void DmxPlayer::traceTick(bool rendered)
+{
+  if (m_trace.isOpen()) {
+    ShowTrace::TickInfo info{};
+    info.playHead = playHead;
+    info.rendered = rendered ? 1 : 0;
+    m_trace.record(ShowTrace::Region::Render, ShowTrace::Type::Tick, m_renderNowUs, &info, sizeof(info));
+  }
+}
+
+//////////////////////////////////////////////////////////
+// OSC thread: have the render thread run the tick and wait for it, so the
+// packets that follow in the trace are not taken in before it
+void DmxPlayer::postReplayTick(int64_t playHeadMs, int64_t nowUs, bool rendered,
+                               const IpEndpointName &to)
+{
+  if (!m_olaConnected) {
+    CuemsLogger::getLogger()->logWarning("OSC: /replay_tick ignored, output not connected");
+    return;
+  }
+
+  uint64_t target = 0;
+  {
+    std::lock_guard guard(m_replayMutex);
+    m_replayRequest = {playHeadMs, nowUs, rendered};
+    target = ++m_replayTicksPosted;
+  }
+  wakeRender();
+
+  uint32_t frames = 0;
+  uint64_t hash = 0;
+  {
+    std::unique_lock lock(m_replayMutex);
+    if (!m_replayCv.wait_for(lock, chrono::seconds(2),
+                             [&] { return m_replayTicksDone >= target; })) {
+      CuemsLogger::getLogger()->logWarning("OSC: /replay_tick timed out");
+      return;
+    }
+    frames = m_replayFrames;
+    hash = m_replayHash;
+  }
+
+  try {
+    UdpTransmitSocket socket(to);
+    char buffer[CuemsConstants::OSC_REPLY_BUFFER_SIZE];
+    osc::OutboundPacketStream p(buffer, sizeof(buffer));
+    p << osc::BeginMessage((OscReceiver::oscAddress + "/replay_tick").c_str())
+      << static_cast<osc::int32>(frames)
+      << static_cast<osc::int64>(hash)
+      << osc::EndMessage;
+    socket.Send(p.Data(), p.Size());
+  } catch (const std::exception &e) {
+    CuemsLogger::getLogger()->logWarning(std::string("OSC: /replay_tick reply failed: ") + e.what());
+  }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread, under --replay: run the tick /replay_tick posted, if any
+void DmxPlayer::runReplayTick()
+{
+  ReplayRequest request;
+  {
+    std::lock_guard guard(m_replayMutex);
+    if (m_replayTicksDone >= m_replayTicksPosted) {
+      return;
+    }
+    request = m_replayRequest;
+  }
+  replayTick(request.playHeadMs, request.nowUs, request.rendered);
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: the body of renderTick() under the replayed clock
+void DmxPlayer::replayTick(int64_t playHeadMs, int64_t nowUs, bool rendered)
+{
+  std::lock_guard guard(m_replayMutex);
+  m_renderNowUs = nowUs;
+  m_replayFrames = 0;
+  m_replayHash = ShowTrace::FRAME_HASH_SEED;
+  playHead = playHeadMs;        // also stamps the packets that follow
+  applyOutputEvents();
+  applyControlCommands();
+  if (rendered) {
+    processScenes();
+    updateActiveUniverses();
+  }
+  sendPatchFrames();
+  flushOutputRequests();
+  ++m_replayTicksDone;
+  m_replayCv.notify_all();
+}
+
+//////////////////////////////////////////////////////////
+DmxPlayer::UniverseTable::UniverseTable()
+    : m_slots(new ActiveUniverse[CuemsConstants::ACTIVE_UNIVERSE_SLOTS])
+{
+  m_used.reserve(CuemsConstants::ACTIVE_UNIVERSE_SLOTS);
+  m_free.reserve(CuemsConstants::ACTIVE_UNIVERSE_SLOTS);
+  for (unsigned int i = CuemsConstants::ACTIVE_UNIVERSE_SLOTS; 0 < i; --i) {
+    ActiveUniverse &slot = m_slots[i - 1];
+    slot.m_channelsBuffer.Blackout();      // allocates the channel storage now
+    slot.m_outputBuffer.Blackout();
+    slot.m_effects.reserve(CuemsConstants::EFFECTS_PER_UNIVERSE_MAX);
+    m_free.push_back(&slot);
+  }
+}
+
+//////////////////////////////////////////////////////////
+DmxPlayer::ActiveUniverse *DmxPlayer::UniverseTable::find(uint32_t id)
+{
+  for (auto *univ : m_used) {
+    if (univ->m_id == id) {
+      return univ;
+    }
+  }
+  return nullptr;
+}
+
+//////////////////////////////////////////////////////////
+DmxPlayer::ActiveUniverse *DmxPlayer::UniverseTable::acquire(uint32_t id)
+{
+  if (auto *univ = find(id)) {
+    return univ;
+  }
+  if (m_free.empty()) {
+    return nullptr;
+  }
+  ActiveUniverse *univ = m_free.back();
+  m_free.pop_back();
+  univ->m_id = id;
+  univ->m_state = 0;
+  univ->m_dirty = false;
+  univ->m_nextTxUs = 0;
+  univ->m_inFlight = 0;
+  univ->m_sequences = 0;
+  univ->m_channelTransitions.clear();
+  univ->m_effects.clear();
+  m_used.push_back(univ);
+  return univ;
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::UniverseTable::releaseAt(size_t index)
+{
+  m_free.push_back(m_used[index]);
+  m_used[index] = m_used.back();
+  m_used.pop_back();
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::UniverseTable::clear()
+{
+  m_free.insert(m_free.end(), m_used.begin(), m_used.end());
+  m_used.clear();
+}
+
+//////////////////////////////////////////////////////////
+// Heap bytes a scene holds once queued: its list node and the storage of
+// its arrays (capacity, not size: that is what stays allocated)
+size_t DmxPlayer::SceneTransitionInfo::footprint() const
+{
+  size_t bytes = sizeof(SceneTransitionInfo) + 2 * sizeof(void *)
+      + m_channels.capacity() * sizeof(SceneChannel)
+      + m_spans.capacity() * sizeof(UniverseSpan)
+      + m_effects.capacity() * sizeof(SceneEffect)
+      + m_effectStops.capacity() * sizeof(SceneEffectStop)
+      + m_fans.capacity() * sizeof(SceneFan);
+  if (m_cueId.capacity() > std::string().capacity()) {
+    bytes += m_cueId.capacity() + 1;    // beyond the small string buffer
+  }
+  return bytes;
+}
+
+//////////////////////////////////////////////////////////
+// Sort the targets collected from a bundle, keep the last value sent for
+// each channel (stable_sort leaves duplicates in arrival order), apply the
+// fans and build the universe spans. Fans only cover this bundle's
+// channels: they are consumed here, so a later merge does not re-apply them.
+void DmxPlayer::SceneTransitionInfo::compile()
+{
+  std::stable_sort(m_channels.begin(), m_channels.end());
+  auto out = m_channels.begin();
+  for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
+    auto next = std::next(it);
+    if (next != m_channels.end() && !(*it < *next)) {
+      continue;
+    }
+    *out++ = *it;
+  }
+  m_channels.erase(out, m_channels.end());
+
+  for (const auto &fan : m_fans) {
+    int steps = (fan.m_channelCount + fan.m_group - 1) / fan.m_group;
+    SceneChannel first;
+    first.m_universe = fan.m_universe;
+    first.m_channel = fan.m_firstChannel;
+    for (auto it = std::lower_bound(m_channels.begin(), m_channels.end(), first);
+         it != m_channels.end() && it->m_universe == fan.m_universe
+           && it->m_channel < fan.m_firstChannel + fan.m_channelCount;
+         ++it) {
+      double pos = (1 < steps) ? 1.0 * ((it->m_channel - fan.m_firstChannel) / fan.m_group) / (steps - 1) : 0.0;
+      it->m_delay = std::round(std::abs(fan.m_delaySpread) * ((fan.m_delaySpread < 0) ? 1.0 - pos : pos));
+      it->m_fadeOffset = std::round(std::abs(fan.m_fadeSpread) * ((fan.m_fadeSpread < 0) ? 1.0 - pos : pos));
+    }
+  }
+  m_fans.clear();
+
+  buildSpans();
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::SceneTransitionInfo::buildSpans()
+{
+  m_spans.clear();
+  uint32_t size = m_channels.size();
+  for (uint32_t begin = 0; begin < size; ) {
+    UniverseSpan span{m_channels[begin].m_universe, begin, begin};
+    while (span.m_end < size && m_channels[span.m_end].m_universe == span.m_universe) {
+      ++span.m_end;
+    }
+    m_spans.push_back(span);
+    begin = span.m_end;
+  }
+
+  // Universes with effects but no channel values still need activating
+  auto addUniverse = [this](uint32_t univ_id) {
+    auto pos = std::lower_bound(m_spans.begin(), m_spans.end(), univ_id,
+        [](const UniverseSpan &span, uint32_t id) { return span.m_universe < id; });
+    if (pos == m_spans.end() || pos->m_universe != univ_id) {
+      m_spans.insert(pos, UniverseSpan{univ_id, 0, 0});
+    }
+  };
+  for (const auto &sfx : m_effects) {
+    addUniverse(sfx.m_universe);
+  }
+  for (const auto &stop : m_effectStops) {
+    addUniverse(stop.m_universe);
+  }
+}
+
+//////////////////////////////////////////////////////////
+// processScenes() only drops the span of a universe once it is applied;
+// before a queued scene is edited, drop the channels and effects left
+// behind by those universes so they are not applied twice.
+void DmxPlayer::SceneTransitionInfo::dropApplied()
+{
+  auto pending = [this](uint32_t univ_id) {
+    return std::binary_search(m_spans.begin(), m_spans.end(), UniverseSpan{univ_id, 0, 0},
+        [](const UniverseSpan &a, const UniverseSpan &b) { return a.m_universe < b.m_universe; });
+  };
+  m_channels.erase(std::remove_if(m_channels.begin(), m_channels.end(),
+      [&pending](const SceneChannel &ch) { return !pending(ch.m_universe); }), m_channels.end());
+  m_effects.erase(std::remove_if(m_effects.begin(), m_effects.end(),
+      [&pending](const SceneEffect &o) { return !pending(o.m_universe); }), m_effects.end());
+  m_effectStops.erase(std::remove_if(m_effectStops.begin(), m_effectStops.end(),
+      [&pending](const SceneEffectStop &o) { return !pending(o.m_universe); }), m_effectStops.end());
+  buildSpans();
+}
+
+//////////////////////////////////////////////////////////
+// Remove the channels a newer scene sets. Both arrays are compiled, so this
+// is a single merge-style pass. Spans must be rebuilt afterwards.
+int DmxPlayer::SceneTransitionInfo::prune(const std::vector<SceneChannel> &newer)
+{
+  auto it_new = newer.begin();
+  auto out = m_channels.begin();
+  for (auto it = m_channels.begin(); it != m_channels.end(); ++it) {
+    while (it_new != newer.end() && *it_new < *it) {
+      ++it_new;
+    }
+    if (it_new != newer.end() && !(*it < *it_new)) {
+      continue;
+    }
+    *out++ = *it;
+  }
+  int pruned = m_channels.end() - out;
+  m_channels.erase(out, m_channels.end());
+  return pruned;
+}
+
+//////////////////////////////////////////////////////////
+// Insert a committed scene keeping m_scenes sorted by start time.
+//
+// Scenes sharing a start time are applied in queue order within the same
+// processScenes() pass, so whatever the newest of them sets wins. We use that
+// at insert time: channel targets (and same-range effects) of the new scene
+// are pruned from older scenes at the same start, since they would be
+// overwritten before ever reaching the wire, and a scene with the same start
+// and fade absorbs the new one instead of growing the queue. Re-sent or
+// corrected cues therefore replace the queued ones instead of piling up.
+//
+// Scenes of a cue keep their identity: they are neither merged into nor
+// absorb other scenes, so /cancel and /replace can find them. The position
+// of the scene in m_scenes is returned, or end() if it was merged; pruned
+// gets the number of superseded targets dropped. Nothing is logged here,
+// m_scenesMutex is held: the caller reports after unlocking.
+std::list<DmxPlayer::SceneTransitionInfo>::iterator DmxPlayer::insertScene(SceneTransitionInfo &&scene, int &pruned)
+{
+  auto pos = m_scenes.end();
+  while (pos != m_scenes.begin() && std::prev(pos)->m_mtcStart > scene.m_mtcStart) {
+    --pos;
+  }
+
+  auto merge_into = m_scenes.end();
+  pruned = 0;
+  for (auto it = pos; it != m_scenes.begin(); ) {
+    --it;
+    if (it->m_mtcStart != scene.m_mtcStart) {
+      break;
+    }
+    it->dropApplied();
+    if (merge_into == m_scenes.end() && it->m_fadeTime == scene.m_fadeTime
+        && 0 == it->m_cueTag && 0 == scene.m_cueTag) {
+      merge_into = it;
+      continue;
+    }
+
+    SceneTransitionInfo &older = *it;
+    pruned += older.prune(scene.m_channels);
+    for (const auto &sfx : scene.m_effects) {
+      older.m_effects.erase(std::remove_if(older.m_effects.begin(), older.m_effects.end(),
+          [&sfx](const SceneEffect &o) {
+            return o.m_universe == sfx.m_universe
+                && o.m_effect.m_firstChannel == sfx.m_effect.m_firstChannel;
+          }), older.m_effects.end());
+    }
+    // Universes left with nothing to do get no span (empty ones that still
+    // carry effects or effect stops keep theirs so they get activated)
+    older.buildSpans();
+    if (older.m_spans.empty()) {
+      forgetCue(older);
+      it = eraseScene(it);
+    }
+    else {
+      countScene(older);
+    }
+  }
+
+  if (merge_into != m_scenes.end()) {
+    auto &target = *merge_into;
+    size_t total = target.m_channels.size() + scene.m_channels.size();
+    target.m_channels.insert(target.m_channels.end(),
+        scene.m_channels.begin(), scene.m_channels.end());
+    // A scene applies its stops before its effects, so once merged the new
+    // stops would no longer reach the effects queued in the target: drop
+    // those here, as applying the two scenes in turn would have
+    for (const auto &stop : scene.m_effectStops) {
+      auto &fxs = target.m_effects;
+      fxs.erase(std::remove_if(fxs.begin(), fxs.end(),
+          [&stop](const SceneEffect &o) {
+            return o.m_universe == stop.m_universe
+                && (stop.m_firstChannel < 0 || o.m_effect.m_firstChannel == stop.m_firstChannel);
+          }), fxs.end());
+    }
+    for (auto &sfx : scene.m_effects) {
+      auto &fxs = target.m_effects;
+      fxs.erase(std::remove_if(fxs.begin(), fxs.end(),
+          [&sfx](const SceneEffect &o) {
+            return o.m_universe == sfx.m_universe
+                && o.m_effect.m_firstChannel == sfx.m_effect.m_firstChannel;
+          }), fxs.end());
+      fxs.push_back(sfx);
+    }
+    target.m_effectStops.insert(target.m_effectStops.end(),
+        scene.m_effectStops.begin(), scene.m_effectStops.end());
+    // Appended after the queued targets, so the new values win
+    target.compile();
+    countScene(target);
+    pruned += total - target.m_channels.size();
+    return m_scenes.end();
+  }
+
+  auto queued = m_scenes.insert(pos, std::move(scene));
+  countScene(*queued);
+  return queued;
+}
+
+//////////////////////////////////////////////////////////
+// Scene queue accounting, m_scenesMutex held: count a queued scene again
+// after it was queued or edited, and uncount it when it leaves the queue
+void DmxPlayer::countScene(SceneTransitionInfo &scene)
+{
+  size_t bytes = scene.footprint();
+  m_queuedSceneBytes = m_queuedSceneBytes - scene.m_bytes + bytes;
+  scene.m_bytes = bytes;
+}
+
+//////////////////////////////////////////////////////////
+// m_scenesMutex held, after the queue changed: queued scenes, and those
+// processScenes() has out of the queue, for the render loop's idle check
+void DmxPlayer::countPendingScenes()
+{
+  m_pendingScenes.store(m_scenes.size() + m_dueScenes.size(), std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////
+std::list<DmxPlayer::SceneTransitionInfo>::iterator DmxPlayer::eraseScene(
+    std::list<SceneTransitionInfo>::iterator it)
+{
+  m_queuedSceneBytes -= it->m_bytes;
+  return m_scenes.erase(it);
+}
+
+//////////////////////////////////////////////////////////
+// Check a compiled scene against the queue caps before it is queued. A
+// cue firing replaces its queued scene (fireCue()), which is not counted.
+// If the scene does not fit, the overflow policy decides:
+//
+//   Reject       the scene is dropped, nothing queued changes
+//   DropOldest   queued scenes are dropped from the earliest start on until
+//                it fits; then it is queued (DroppedOldest)
+//   Coalesce     if a queued scene has the same start and fade, it is merged
+//                into it (the insertScene() merge) and the queue does not
+//                grow; otherwise, for cue scenes, or if the merge could
+//                break the byte cap, it is rejected
+//
+// Overflow handling never changes when a scene starts or how it fades. A
+// scene above the byte cap on its own is always rejected. full is set when
+// the queue has just filled up, for the caller to warn once it unlocks.
+DmxPlayer::Admission DmxPlayer::admitScene(SceneTransitionInfo &scene, int &dropped, int &pruned, bool &full)
+{
+  dropped = 0;
+  full = false;
+  const size_t size = scene.footprint();
+  auto replaced = [this, &scene]() -> const SceneTransitionInfo * {
+    if (scene.m_cueId.empty()) {
+      return nullptr;
+    }
+    auto found = m_cues.find(scene.m_cueId);
+    if (found == m_cues.end() || !found->second.queued || found->second.scene->m_spans.empty()) {
+      return nullptr;
+    }
+    return &*found->second.scene;
+  };
+  auto merges = [this, &scene]() {
+    if (!scene.m_cueId.empty()) {
+      return false;
+    }
+    for (auto it = m_scenes.rbegin(); it != m_scenes.rend() && it->m_mtcStart >= scene.m_mtcStart; ++it) {
+      if (it->m_mtcStart == scene.m_mtcStart && it->m_fadeTime == scene.m_fadeTime && 0 == it->m_cueTag) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto fits = [&]() {
+    size_t scenes = m_scenes.size();
+    size_t bytes = m_queuedSceneBytes + size;
+    if (const auto *old = replaced()) {
+      --scenes;
+      bytes -= old->m_bytes;
+    }
+    return (0 == m_maxQueuedScenes || scenes < m_maxQueuedScenes)
+        && (0 == m_maxQueuedSceneBytes || bytes <= m_maxQueuedSceneBytes);
+  };
 
-    // Starting OLA logging
-    ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+  if (fits()) {
+    m_sceneQueueFull = false;
+    return Admission::Fits;
+  }
+  if (!m_sceneQueueFull) {
+    m_sceneQueueFull = true;
+    full = true;
+  }
 
-    // OLA connection is established (with retry) in run(). Readiness is already
-    // gated in main(), which waits for olad to be reachable before constructing
-    // us — so no redundant fail-fast probe is needed here. (A probe here would
-    // also exit() on a transient olad blip, bypassing main's catch.)
+  Admission admission = Admission::Rejected;
+  bool tooLarge = 0 != m_maxQueuedSceneBytes && size > m_maxQueuedSceneBytes;
+  if (SceneOverflow::DropOldest == m_sceneOverflow && !tooLarge) {
+    while (!fits() && !m_scenes.empty()) {
+      forgetCue(m_scenes.front());
+      eraseScene(m_scenes.begin());
+      ++dropped;
+    }
+    admission = Admission::DroppedOldest;
+  }
+  else if (SceneOverflow::Coalesce == m_sceneOverflow && merges()
+           && (0 == m_maxQueuedSceneBytes || m_queuedSceneBytes + size <= m_maxQueuedSceneBytes)) {
+    insertScene(std::move(scene), pruned);
+    admission = Admission::Coalesced;
+  }
 
+  switch (admission) {
+    case Admission::DroppedOldest:
+      m_scenesDropped.fetch_add(dropped, std::memory_order_relaxed);
+      break;
+    case Admission::Coalesced:
+      m_scenesCoalesced.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      m_scenesRejected.fetch_add(1, std::memory_order_relaxed);
+      break;
+  }
+  return admission;
 }
 
 //////////////////////////////////////////////////////////
-DmxPlayer::~DmxPlayer( void ) {
+// Tag a scene that carries a cue ID. A firing of the same cue still queued
+// is dropped: a cue ID names one queued scene. With /replace the new
+// payload also keeps the dropped scene's start unless the bundle set its
+// own, and the tag of the previous firing is returned so what it started
+// can be stopped (0 otherwise).
+uint32_t DmxPlayer::fireCue(SceneTransitionInfo &scene)
+{
+  uint32_t stopTag = 0;
+  auto found = m_cues.find(scene.m_cueId);
+  if (found != m_cues.end()) {
+    CueEntry &cue = found->second;
+    if (cue.queued && !cue.scene->m_spans.empty()) {
+      if (scene.m_replace && !scene.m_timed) {
+        scene.m_mtcStart = cue.scene->m_mtcStart;
+        scene.m_internalClock = cue.scene->m_internalClock;
+      }
+      eraseScene(cue.scene);
+      cue.queued = false;
+    }
+    if (scene.m_replace) {
+      stopTag = cue.tag;
+    }
+  }
+  if (0 == ++m_lastCueTag) {
+    ++m_lastCueTag;
+  }
+  scene.m_cueTag = m_lastCueTag;
+  return stopTag;
+}
 
+//////////////////////////////////////////////////////////
+// Drop a cue from the index and its scene from the queue. tag is set to
+// its latest firing, to stop what that started. False for unknown cues.
+bool DmxPlayer::cancelCue(const std::string &cueId, uint32_t &tag)
+{
+  auto found = m_cues.find(cueId);
+  if (found == m_cues.end()) {
+    return false;
+  }
+  CueEntry &cue = found->second;
+  if (cue.queued && !cue.scene->m_spans.empty()) {
+    eraseScene(cue.scene);
+  }
+  tag = cue.tag;
+  m_cues.erase(found);
+  return true;
 }
 
 //////////////////////////////////////////////////////////
-void DmxPlayer::setOutputLatencyMs(long ms) {
-    if (ms < 0) ms = 0;
-    if (ms > 500) ms = 500;
-    m_outputLatencyMs.store(ms);
-    CuemsLogger::getLogger()->logInfo(
-        "DMX output latency compensation updated to "
-        + std::to_string(ms) + " ms");
+// A scene is about to be freed: its cue entry, if it still points at it,
+// no longer has a queued scene
+void DmxPlayer::forgetCue(const SceneTransitionInfo &scene)
+{
+  if (scene.m_cueId.empty()) {
+    return;
+  }
+  auto found = m_cues.find(scene.m_cueId);
+  if (found != m_cues.end() && found->second.tag == scene.m_cueTag) {
+    found->second.queued = false;
+  }
 }
 
 //////////////////////////////////////////////////////////
-void DmxPlayer::ProcessBundle( const osc::ReceivedBundle& b,
-                               const IpEndpointName& remoteEndpoint )
+void DmxPlayer::clearRetiredScenes()
 {
-  // set 'now' MTC by default if it's a top-leven bundle;
-  if (0 == m_inBundle) {
-    m_nextScene.m_mtcStart = playHead;
+  for (const auto &scene : m_retiredScenes) {
+    forgetCue(scene);
   }
-  ++m_inBundle;
-  std::cout << "DmxPlayer::ProcessBundle => " << m_inBundle
-    << " thread=" << std::this_thread::get_id()
-    << std::endl;
-  OscReceiver::ProcessBundle(b, remoteEndpoint);
-  --m_inBundle;
-  std::cout << "DmxPlayer::ProcessBundle <= " << m_inBundle
-    << "  values:" << m_nextScene.m_sceneValues.size() << std::endl;
+  m_retiredScenes.clear();
+}
 
-  // If it's a top-level bundle, add m_nextScene to scenes
-  if (0 == m_inBundle) {
-    {
-      std::lock_guard guard(m_scenesMutex);
-      auto r_it = m_scenes.rbegin();
-      for (; r_it != m_scenes.rend(); ++r_it) {
-        if (r_it->m_mtcStart <= m_nextScene.m_mtcStart) {
-          break;
-        }
+//////////////////////////////////////////////////////////
+// OSC thread: compile m_nextSequence and make it the definition of its ID.
+// A definition it replaces is stopped and freed once the render thread
+// is done with it. If the stop cannot be queued the old definition might
+// keep running out of reach, so the new one is rejected instead.
+void DmxPlayer::defineSequence()
+{
+  std::unique_ptr<DmxSequence> seq = std::move(m_nextSequence);
+  std::string error;
+  if (!seq->compile(error)) {
+    CuemsLogger::getLogger()->logWarning("OSC: Invalid /sequence " + seq->id() + ": " + error);
+    return;
+  }
+  clearRetiredSequences();
+  auto &slot = m_sequences[seq->id()];
+  if (slot && !slot->idle()) {
+    ControlCommand command;
+    command.type = ControlCommand::Type::SequenceStop;
+    command.sequence = slot.get();
+    if (!postSequence(command)) {
+      CuemsLogger::getLogger()->logWarning("Sequence " + seq->id() + ": cannot stop the running definition, "
+          + "the new one is ignored");
+      return;
+    }
+    m_retiredSequences.push_back(std::move(slot));
+  }
+  CuemsLogger::getLogger()->logInfo("Sequence " + seq->id() + ": " + std::to_string(seq->stepCount())
+      + " step(s) over " + std::to_string(seq->tracks().size()) + " universe(s)");
+  slot = std::move(seq);
+}
+
+//////////////////////////////////////////////////////////
+bool DmxPlayer::postSequence(ControlCommand &command)
+{
+  ++command.sequence->m_commandsPosted;
+  if (!postControl(command)) {
+    --command.sequence->m_commandsPosted;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::clearRetiredSequences()
+{
+  m_retiredSequences.erase(std::remove_if(m_retiredSequences.begin(), m_retiredSequences.end(),
+      [](const std::unique_ptr<DmxSequence> &seq) { return seq->idle(); }), m_retiredSequences.end());
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: start (or restart, from the current values) a sequence.
+// Its universes are claimed now and fetched by updateActiveUniverses();
+// a universe with no free slot is left out.
+void DmxPlayer::startSequence(DmxSequence *seq, long int head, int loops)
+{
+  if (!seq->m_running.load(std::memory_order_relaxed)) {
+    if (CuemsConstants::SEQUENCE_MAX_RUNNING <= m_runningSequences.size()) {
+      m_renderLog.post(RenderLog::Level::Warning, "%u sequences already running, /seq_start ignored",
+          CuemsConstants::SEQUENCE_MAX_RUNNING);
+      return;
+    }
+    for (auto &track : seq->tracks()) {
+      auto *slot = m_activeUniverses.acquire(track.universe);
+      track.attached = (slot != nullptr);
+      if (slot == nullptr) {
+        m_renderLog.post(RenderLog::Level::Warning,
+            "All %u universe slots in use, sequence leaves universe %u out",
+            CuemsConstants::ACTIVE_UNIVERSE_SLOTS, track.universe);
+        continue;
+      }
+      ++slot->m_sequences;
+    }
+    m_runningSequences.push_back(seq);
+  }
+  seq->start(head, loops);
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: the channels hold the values the sequence left them at
+void DmxPlayer::stopSequence(DmxSequence *seq)
+{
+  auto it = std::find(m_runningSequences.begin(), m_runningSequences.end(), seq);
+  if (it == m_runningSequences.end()) {
+    return;
+  }
+  for (auto &track : seq->tracks()) {
+    if (!track.attached) {
+      continue;
+    }
+    track.attached = false;
+    auto *univ = m_activeUniverses.find(track.universe);
+    if (univ != nullptr && 0 < univ->m_sequences) {
+      --univ->m_sequences;
+    }
+  }
+  *it = m_runningSequences.back();
+  m_runningSequences.pop_back();
+  seq->m_running.store(false, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::renderSequences(ActiveUniverse &univ)
+{
+  uint8_t frame[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+  size_t size = std::min<size_t>(univ.m_channelsBuffer.Size(), CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+  std::memcpy(frame, univ.m_channelsBuffer.GetRaw(), size);
+  for (auto *seq : m_runningSequences) {
+    for (auto &track : seq->tracks()) {
+      if (track.attached && track.universe == univ.m_id) {
+        seq->render(track, playHead, frame, size);
+      }
+    }
+  }
+  univ.m_channelsBuffer.Set(frame, size);
+}
+
+//////////////////////////////////////////////////////////
+// Sequences past their last loop stop after rendering their end values
+void DmxPlayer::finishSequences()
+{
+  for (size_t i = 0; i < m_runningSequences.size();) {
+    DmxSequence *seq = m_runningSequences[i];
+    if (seq->finished(playHead)) {
+      stopSequence(seq);        // swaps the last one in
+    }
+    else {
+      ++i;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////
+// OSC thread: the play-head new scenes start from. On the internal clock it
+// is read live rather than taken from the last tick, so a Go cue is timed
+// from its arrival even while the render timer idles. internal tells
+// whether it came from the internal clock.
+long int DmxPlayer::stampHead(bool &internal) const
+{
+  internal = !m_replay && m_internalClock.load(std::memory_order_acquire);
+  if (!internal) {
+    return playHead;
+  }
+  int64_t nowUs = chrono::duration_cast<chrono::microseconds>(
+      chrono::steady_clock::now().time_since_epoch()).count();
+  return (nowUs + m_clockOffsetUs.load(std::memory_order_relaxed)) / 1000;
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: the play-head moves from the internal clock back to MTC.
+// Running fades and effects, and the scenes queued on the internal clock,
+// are shifted by the jump so they go on from where they were; scenes timed
+// while following MTC keep their MTC time.
+void DmxPlayer::rebaseTimeline(long int deltaMs)
+{
+  for (auto *univ : m_activeUniverses) {
+    auto &transitions = univ->m_channelTransitions;
+    for (uint16_t channel : transitions.m_active) {
+      auto &trs = transitions.m_slots[channel];
+      trs.mtc0 += deltaMs;
+      trs.mtc1 += deltaMs;
+    }
+    for (auto &fx : univ->m_effects) {
+      fx.m_mtcStart += deltaMs;
+      if (fx.m_mtcEnd != std::numeric_limits<long int>::max()) {
+        fx.m_mtcEnd += deltaMs;
       }
-      m_scenes.insert(r_it.base(), std::move(m_nextScene));
     }
+  }
+
+  for (auto *seq : m_runningSequences) {
+    seq->shift(deltaMs);
+  }
+
+  std::lock_guard guard(m_scenesMutex);
+  for (auto &sc : m_scenes) {
+    if (sc.m_internalClock) {
+      sc.m_mtcStart += deltaMs;
+      sc.m_internalClock = false;
+    }
+  }
+  // Shifting only some scenes may break the start time order
+  m_scenes.sort([](const SceneTransitionInfo &a, const SceneTransitionInfo &b) {
+    return a.m_mtcStart < b.m_mtcStart;
+  });
+  m_renderLog.post(RenderLog::Level::Info, "Play-head back on MTC, internal clock timeline shifted by %ld ms",
+      deltaMs);
+}
 
-    // If on idle timer, wake up the SelectServer to switch to active (10ms).
-    // Execute() is thread-safe and interrupts select() immediately.
-    if (m_isIdleTimer && olaServer != nullptr && m_olaConnected) {
-      olaServer->Execute(
-          ola::NewSingleCallback(this, &DmxPlayer::switchToActiveTimer));
+//////////////////////////////////////////////////////////
+// Render thread: stop the fades and effects a cue firing started. Fades
+// hold the value they reached; fades still waiting for their start or fan
+// delay never begin.
+void DmxPlayer::stopCue(uint32_t tag)
+{
+  long int now = playHead;
+  for (auto *univ : m_activeUniverses) {
+    auto &transitions = univ->m_channelTransitions;
+    for (size_t i = 0; i < transitions.m_active.size();) {
+      auto &trs = transitions.m_slots[transitions.m_active[i]];
+      if (trs.cue == tag) {
+        trs.active = false;
+        transitions.m_active[i] = transitions.m_active.back();
+        transitions.m_active.pop_back();
+      }
+      else {
+        ++i;
+      }
+    }
+    for (auto &fx : univ->m_effects) {
+      if (fx.m_cue == tag) {
+        fx.m_mtcEnd = std::min(fx.m_mtcEnd, now);
+      }
     }
   }
 }
 
+//////////////////////////////////////////////////////////
+// Cue IDs are strings (cue UUIDs) or integers
+static std::string readCueId(const osc::ReceivedMessage &m)
+{
+    auto arg = m.ArgumentsBegin();
+    if (arg == m.ArgumentsEnd()) {
+        throw osc::MissingArgumentException();
+    }
+    if (arg->IsInt32()) {
+        return std::to_string(arg->AsInt32());
+    }
+    return arg->AsString();
+}
+
+//////////////////////////////////////////////////////////
+// The values of one /frame_range or /frame_runs run: a blob of bytes, or
+// count int arguments (count < 0: up to the end of the message). Values are
+// checked once per run: OR-ing them leaves bits above MAX_DMX_VALUE if any
+// is out of range. Returns the number of values, -1 for an invalid run.
+static int readFrameRun(osc::ReceivedMessageArgumentIterator &arg,
+                        const osc::ReceivedMessageArgumentIterator &end,
+                        int count, uint8_t *values)
+{
+    if (arg != end && arg->IsBlob()) {
+        const void *data = nullptr;
+        osc::osc_bundle_element_size_t size = 0;
+        (arg++)->AsBlobUnchecked(data, size);
+        if (size > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+            return -1;
+        }
+        std::memcpy(values, data, size);
+        return size;
+    }
+    if (count < 0) {
+        count = std::distance(arg, end);
+    }
+    if (count > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+        return -1;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < count; ++i, ++arg) {
+        if (arg == end) {
+            throw osc::MissingArgumentException();
+        }
+        int32_t value = arg->AsInt32();
+        bits |= static_cast<uint32_t>(value);
+        values[i] = value;
+    }
+    return (bits > CuemsConstants::MAX_DMX_VALUE) ? -1 : count;
+}
+
+//////////////////////////////////////////////////////////
+// One validated run of channels [start, start + count) into the scene (or
+// sequence step) being parsed, appended in one piece
+void DmxPlayer::addFrameRun(uint32_t universe, int start, const uint8_t *values, int count)
+{
+    if (m_nextSequence) {
+        for (int i = 0; i < count; ++i) {
+            m_nextSequence->addValue(universe, start + i, values[i]);
+        }
+        return;
+    }
+    auto &channels = m_nextScene.m_channels;
+    size_t at = channels.size();
+    channels.resize(at + count);
+    for (int i = 0; i < count; ++i) {
+        SceneChannel &ch = channels[at + i];
+        ch.m_universe = universe;
+        ch.m_channel = start + i;
+        ch.m_value = values[i];
+    }
+}
+
 //////////////////////////////////////////////////////////
 void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
-            const IpEndpointName& /*remoteEndpoint*/ )
+            const IpEndpointName& remoteEndpoint )
 {
+    m_ingestMessages.fetch_add(1, std::memory_order_relaxed);
     try {
         // Parsing OSC DmxPlayer messages
         // Quit
@@ -135,6 +1694,59 @@ void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/check") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /check command");
             raise(SIGUSR1);
+        // Stats
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/stats") ) {
+            CuemsLogger::getLogger()->logInfo("OSC: /stats command");
+            auto stats = collectStats();
+            logStats(stats);
+            sendStats(stats, remoteEndpoint);
+        // Output state, for every universe or the listed ones
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/get_state") ) {
+            std::vector<uint32_t> universes;
+            auto stream = m.ArgumentStream();
+            while (!stream.Eos()) {
+              int universe_id = -1;
+              stream >> universe_id;
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /get_state command: " + std::to_string(universe_id));
+                  return;
+              }
+              universes.push_back(universe_id);
+            }
+            sendState(universes, remoteEndpoint);
+        // Replay mode: run one render tick at a recorded play-head and time
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/replay_tick") ) {
+            if (!m_replay) {
+                CuemsLogger::getLogger()->logWarning("OSC: /replay_tick ignored, not in replay mode");
+                return;
+            }
+            auto stream = m.ArgumentStream();
+            osc::int64 playHeadMs = 0;
+            osc::int64 nowUs = 0;
+            int rendered = 1;
+            stream >> playHeadMs >> nowUs;
+            if (!stream.Eos()) {
+              stream >> rendered;
+            }
+            stream >> osc::EndMessage;
+            postReplayTick(playHeadMs, nowUs, rendered != 0, remoteEndpoint);
+        // Output rate cap, global or for one universe
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/output_rate") ) {
+            CuemsLogger::getLogger()->logInfo("OSC: /output_rate command");
+            auto stream = m.ArgumentStream();
+            int fps = 0;
+            stream >> fps;
+            if (!stream.Eos()) {
+              int universe_id = -1;
+              stream >> universe_id >> osc::EndMessage;
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /output_rate command: " + std::to_string(universe_id));
+                  return;
+              }
+              setOutputFpsCap(static_cast<uint32_t>(universe_id), fps);
+            } else {
+              setOutputFpsCap(fps);
+            }
         // Stop on lost
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/stoponlost") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /stoponlost command");
@@ -153,20 +1765,24 @@ void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
         // Blackout: clear all scenes and fades, send zeros to OLA
         } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/blackout") ) {
             CuemsLogger::getLogger()->logInfo("OSC: /blackout command");
+            ControlCommand command;
             {
                 std::lock_guard guard(m_scenesMutex);
                 m_scenes.clear();
+                m_retiredScenes.clear();
+                m_cues.clear();
+                m_queuedSceneBytes = 0;
+                // Under the lock: scenes the render loop has out of the
+                // queue are then not put back (processScenes())
+                command.value = int(m_blackoutRequests.fetch_add(1, std::memory_order_release) + 1);
+                countPendingScenes();
             }
-            {
-                std::lock_guard guard(m_universesMutex);
-                for (auto &[univ_id, univ] : m_activeUniverses) {
-                    univ.m_channelTransitions.clear();
-                    univ.m_channelsBuffer.Blackout();
-                    if (m_olaConnected) {
-                        m_olaWrapper->GetClient()->SendDMX(univ.m_id, univ.m_channelsBuffer, ola::client::SendDMXArgs());
-                    }
-                }
-                m_activeUniverses.clear();
+            // The universes themselves are cleared by the render loop. If
+            // the command cannot be queued it still picks the request up
+            // from m_blackoutRequests on its next tick.
+            command.type = ControlCommand::Type::Blackout;
+            if (!postControl(command)) {
+                wakeRender();
             }
             // Clear the >24h wrap accumulator on project-clear. MtcReceiver keeps
             // it in a process-global static; this long-running daemon would
@@ -175,6 +1791,140 @@ void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
             // reload's small backward delta). (Plan 3b)
             MtcReceiver::resetWrapOffset();
 
+        // Grand master, optionally faded
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/master") ) {
+            auto stream = m.ArgumentStream();
+            float level = 0;
+            float fade = 0;
+            stream >> level;
+            if (!stream.Eos()) {
+              stream >> fade;
+            }
+            stream >> osc::EndMessage;
+            setMasterLevel(0, level, fade);
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/submaster") ) {
+            auto stream = m.ArgumentStream();
+            int sub = 0;
+            float level = 0;
+            float fade = 0;
+            stream >> sub >> level;
+            if (!stream.Eos()) {
+              stream >> fade;
+            }
+            stream >> osc::EndMessage;
+            if (sub < 1 || sub > static_cast<int>(CuemsConstants::SUBMASTER_COUNT)) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid submaster in /submaster command: " + std::to_string(sub));
+                return;
+            }
+            setMasterLevel(sub, level, fade);
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/submaster_assign") ) {
+            CuemsLogger::getLogger()->logInfo("OSC: /submaster_assign command");
+            auto stream = m.ArgumentStream();
+            int sub = 0;
+            int universe_id = -1;
+            int first = -1;
+            int count = 0;
+            int on = 1;
+            stream >> sub >> universe_id >> first >> count;
+            if (!stream.Eos()) {
+              stream >> on;
+            }
+            stream >> osc::EndMessage;
+            if (sub < 1 || sub > static_cast<int>(CuemsConstants::SUBMASTER_COUNT)) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid submaster in /submaster_assign command: " + std::to_string(sub));
+                return;
+            }
+            if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /submaster_assign command: " + std::to_string(universe_id));
+                return;
+            }
+            if (first < CuemsConstants::MIN_CHANNEL_ID || count < 1
+                || first + count > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid channel range in /submaster_assign command: "
+                    + std::to_string(first) + "+" + std::to_string(count));
+                return;
+            }
+            assignSubmaster(sub, universe_id, first, count, 0 != on);
+
+        // Start, stop or re-time a defined sequence
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/seq_start")
+                    || (string)m.AddressPattern() == (OscReceiver::oscAddress + "/seq_stop")
+                    || (string)m.AddressPattern() == (OscReceiver::oscAddress + "/seq_rate") ) {
+            std::string address = m.AddressPattern();
+            std::string command_name = address.substr(address.rfind('/'));
+            std::string id = readCueId(m);
+            CuemsLogger::getLogger()->logInfo("OSC: " + command_name + " command, sequence " + id);
+            auto found = m_sequences.find(id);
+            if (found == m_sequences.end()) {
+                CuemsLogger::getLogger()->logWarning("OSC: Unknown sequence in " + command_name + " command: " + id);
+                return;
+            }
+            ControlCommand command;
+            command.sequence = found->second.get();
+            auto arg = std::next(m.ArgumentsBegin());
+            if ("/seq_start" == command_name) {
+                bool internal = false;
+                command.type = ControlCommand::Type::SequenceStart;
+                command.head = stampHead(internal);
+                command.value = (arg != m.ArgumentsEnd()) ? arg->AsInt32() : -1;
+                if (arg != m.ArgumentsEnd() && command.value < 0) {
+                    CuemsLogger::getLogger()->logWarning("OSC: Invalid loop count in /seq_start command");
+                    return;
+                }
+            }
+            else if ("/seq_stop" == command_name) {
+                command.type = ControlCommand::Type::SequenceStop;
+            }
+            else {
+                command.type = ControlCommand::Type::SequenceRate;
+                command.rate = (arg != m.ArgumentsEnd()) ? arg->AsFloat() : 0;
+                if (!std::isfinite(command.rate) || command.rate <= 0) {
+                    CuemsLogger::getLogger()->logWarning("OSC: Invalid rate in /seq_rate command");
+                    return;
+                }
+            }
+            postSequence(command);
+
+        // Cancel one cue: drop its queued scene and stop its running fades
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/cancel") ) {
+            std::string cueId = readCueId(m);
+            CuemsLogger::getLogger()->logInfo("OSC: /cancel command, cue " + cueId);
+            uint32_t tag = 0;
+            bool found = false;
+            {
+                std::lock_guard guard(m_scenesMutex);
+                found = cancelCue(cueId, tag);
+                countPendingScenes();
+            }
+            if (!found) {
+                CuemsLogger::getLogger()->logWarning("OSC: Unknown cue in /cancel command: " + cueId);
+                return;
+            }
+            ControlCommand command;
+            command.type = ControlCommand::Type::StopCue;
+            command.cue = tag;
+            postControl(command);
+        } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/patch_load") ) {
+            // No argument: reload the current patch file
+            auto stream = m.ArgumentStream();
+            std::string path;
+            if (!stream.Eos()) {
+                const char *arg = nullptr;
+                stream >> arg;
+                path = arg;
+            }
+            stream >> osc::EndMessage;
+            if (path.empty()) {
+                std::lock_guard guard(m_patchMutex);
+                path = m_patchPath;
+            }
+            CuemsLogger::getLogger()->logInfo("OSC: /patch_load command, " + path);
+            if (path.empty()) {
+                CuemsLogger::getLogger()->logWarning("OSC: No patch file to reload in /patch_load command");
+                return;
+            }
+            setPatchFile(path);
+
         // We only accept the following commands from a bundle
         } else if (0 < m_inBundle) {
           if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/frame") ) {
@@ -183,25 +1933,233 @@ void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
               int universe_id;
               stream >> universe_id;
               if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
-                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /frame command: " + std::to_string(universe_id));
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /frame command: " + std::to_string(universe_id));
+                  return;
+              }
+              std::cout << "OSC: /frame universe=" << universe_id << std::endl;
+              if (m_nextSequence && 0 == m_nextSequence->stepCount()) {
+                  CuemsLogger::getLogger()->logWarning("OSC: /frame before the first /seq_step of a sequence");
+                  return;
+              }
+              auto &channels = m_nextScene.m_channels;
+              while (!stream.Eos()) {
+                int channel = -1;
+                int value = -1;
+                stream >> channel >> value;
+                if (channel < CuemsConstants::MIN_CHANNEL_ID || channel > CuemsConstants::MAX_CHANNEL_ID) {
+                    CuemsLogger::getLogger()->logWarning("OSC: Invalid channel in /frame command: " + std::to_string(channel));
+                    continue;
+                }
+                if (value < CuemsConstants::MIN_DMX_VALUE || value > CuemsConstants::MAX_DMX_VALUE) {
+                    CuemsLogger::getLogger()->logWarning("OSC: Invalid value in /frame command: " + std::to_string(value));
+                    continue;
+                }
+                if (m_nextSequence) {
+                    m_nextSequence->addValue(universe_id, channel, value);
+                    continue;
+                }
+                SceneChannel ch;
+                ch.m_universe = universe_id;
+                ch.m_channel = channel;
+                ch.m_value = value;
+                channels.push_back(ch);
+              }
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/frame_range")
+                   || (string)m.AddressPattern() == (OscReceiver::oscAddress + "/frame_runs") ) {
+              // /frame_range <universe> <start> <v1> <v2> ... | <blob>
+              // /frame_runs <universe> (<start> <count> <v1> ... <vcount> | <start> <blob>) ...
+              const bool runs = (string)m.AddressPattern() == (OscReceiver::oscAddress + "/frame_runs");
+              const char *command = runs ? "/frame_runs" : "/frame_range";
+              CuemsLogger::getLogger()->logInfo(std::string("OSC: ") + command + " command");
+              auto arg = m.ArgumentsBegin();
+              auto end = m.ArgumentsEnd();
+              if (arg == end) {
+                  throw osc::MissingArgumentException();
+              }
+              int universe_id = (arg++)->AsInt32();
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning(std::string("OSC: Invalid universe_id in ") + command
+                      + " command: " + std::to_string(universe_id));
+                  return;
+              }
+              if (m_nextSequence && 0 == m_nextSequence->stepCount()) {
+                  CuemsLogger::getLogger()->logWarning(std::string("OSC: ") + command
+                      + " before the first /seq_step of a sequence");
+                  return;
+              }
+              uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+              do {
+                if (arg == end) {
+                    throw osc::MissingArgumentException();
+                }
+                int start = (arg++)->AsInt32();
+                int count = -1;
+                if (runs && arg != end && !arg->IsBlob()) {
+                    count = (arg++)->AsInt32();
+                    if (count < 0) {
+                        CuemsLogger::getLogger()->logWarning(std::string("OSC: Invalid count in ") + command
+                            + " command: " + std::to_string(count));
+                        return;
+                    }
+                }
+                int size = readFrameRun(arg, end, count, values);
+                if (size < 0 || start < CuemsConstants::MIN_CHANNEL_ID
+                    || start + size > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                    CuemsLogger::getLogger()->logWarning(std::string("OSC: Invalid run in ") + command
+                        + " command at channel " + std::to_string(start));
+                    if (size < 0 && count > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                        return;     // the rest of the message can't be found
+                    }
+                    continue;
+                }
+                addFrameRun(universe_id, start, values, size);
+              } while (runs && arg != end);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/effect") ) {
+              CuemsLogger::getLogger()->logInfo("OSC: /effect command");
+              auto stream = m.ArgumentStream();
+              int universe_id = -1;
+              int first = -1;
+              int count = 0;
+              const char *waveform = nullptr;
+              float rate = 0;
+              float spread = 0;
+              int amplitude = 0;
+              int offset = 0;
+              float duration = 0;
+              stream >> universe_id >> first >> count >> waveform
+                     >> rate >> spread >> amplitude >> offset;
+              if (!stream.Eos()) {
+                stream >> duration;
+              }
+              stream >> osc::EndMessage;
+
+              SceneEffect fx;
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /effect command: " + std::to_string(universe_id));
+                  return;
+              }
+              if (first < CuemsConstants::MIN_CHANNEL_ID || count < 1
+                  || first + count > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid channel range in /effect command: "
+                      + std::to_string(first) + "+" + std::to_string(count));
+                  return;
+              }
+              if (!DmxEffect::parseWaveform(waveform, fx.m_effect.m_waveform)) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid waveform in /effect command: " + std::string(waveform));
+                  return;
+              }
+              if (!std::isfinite(rate) || !std::isfinite(spread) || !std::isfinite(duration)
+                  || rate < 0 || duration < 0
+                  || amplitude < CuemsConstants::MIN_DMX_VALUE || amplitude > CuemsConstants::MAX_DMX_VALUE
+                  || offset < CuemsConstants::MIN_DMX_VALUE || offset > CuemsConstants::MAX_DMX_VALUE) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid parameters in /effect command");
+                  return;
+              }
+              fx.m_universe = universe_id;
+              fx.m_effect.m_firstChannel = first;
+              fx.m_effect.m_channelCount = count;
+              fx.m_effect.m_rate = std::min(rate, CuemsConstants::EFFECT_RATE_MAX_HZ);
+              fx.m_effect.m_spread = spread;
+              fx.m_effect.m_amplitude = amplitude;
+              fx.m_effect.m_offset = offset;
+              fx.m_duration = std::round(1000 * std::min(duration, CuemsConstants::OSC_TIME_MAX_S));
+              m_nextScene.m_effects.push_back(fx);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/effect_stop") ) {
+              CuemsLogger::getLogger()->logInfo("OSC: /effect_stop command");
+              auto stream = m.ArgumentStream();
+              SceneEffectStop stop;
+              int universe_id = -1;
+              stream >> universe_id;
+              if (!stream.Eos()) {
+                stream >> stop.m_firstChannel;
+              }
+              stream >> osc::EndMessage;
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /effect_stop command: " + std::to_string(universe_id));
+                  return;
+              }
+              stop.m_universe = universe_id;
+              m_nextScene.m_effectStops.push_back(stop);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/fan") ) {
+              CuemsLogger::getLogger()->logInfo("OSC: /fan command");
+              auto stream = m.ArgumentStream();
+              int universe_id = -1;
+              int first = -1;
+              int count = 0;
+              float delay_spread = 0;
+              float fade_spread = 0;
+              int group = 1;
+              stream >> universe_id >> first >> count >> delay_spread;
+              if (!stream.Eos()) {
+                stream >> fade_spread;
+              }
+              if (!stream.Eos()) {
+                stream >> group;
+              }
+              stream >> osc::EndMessage;
+
+              if (universe_id < CuemsConstants::MIN_UNIVERSE_ID || universe_id > CuemsConstants::MAX_UNIVERSE_ID) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid universe_id in /fan command: " + std::to_string(universe_id));
                   return;
               }
-              std::cout << "OSC: /frame universe=" << universe_id << std::endl;
-              auto &frame_values = m_nextScene.m_sceneValues[universe_id];
-              while (!stream.Eos()) {
-                int channel = -1;
-                int value = -1;
-                stream >> channel >> value;
-                if (channel < CuemsConstants::MIN_CHANNEL_ID || channel > CuemsConstants::MAX_CHANNEL_ID) {
-                    CuemsLogger::getLogger()->logWarning("OSC: Invalid channel in /frame command: " + std::to_string(channel));
-                    continue;
-                }
-                if (value < CuemsConstants::MIN_DMX_VALUE || value > CuemsConstants::MAX_DMX_VALUE) {
-                    CuemsLogger::getLogger()->logWarning("OSC: Invalid value in /frame command: " + std::to_string(value));
-                    continue;
-                }
-                frame_values[channel] = value;
+              if (first < CuemsConstants::MIN_CHANNEL_ID || count < 1
+                  || first + count > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid channel range in /fan command: "
+                      + std::to_string(first) + "+" + std::to_string(count));
+                  return;
+              }
+              if (group < 1 || !std::isfinite(delay_spread) || !std::isfinite(fade_spread)) {
+                  CuemsLogger::getLogger()->logWarning("OSC: Invalid parameters in /fan command");
+                  return;
               }
+              SceneFan fan;
+              fan.m_universe = universe_id;
+              fan.m_firstChannel = first;
+              fan.m_channelCount = count;
+              fan.m_delaySpread = std::round(1000 * std::clamp(delay_spread,
+                  -CuemsConstants::OSC_TIME_MAX_S, CuemsConstants::OSC_TIME_MAX_S));
+              fan.m_fadeSpread = std::round(1000 * std::clamp(fade_spread,
+                  -CuemsConstants::OSC_TIME_MAX_S, CuemsConstants::OSC_TIME_MAX_S));
+              fan.m_group = group;
+              m_nextScene.m_fans.push_back(fan);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/sequence") ) {
+            std::string id = readCueId(m);
+            CuemsLogger::getLogger()->logInfo("OSC: /sequence command, " + id);
+            int loops = 0;
+            float rate = 1;
+            auto arg = std::next(m.ArgumentsBegin());
+            if (arg != m.ArgumentsEnd()) {
+              loops = (arg++)->AsInt32();
+            }
+            if (arg != m.ArgumentsEnd()) {
+              rate = (arg++)->AsFloat();
+            }
+            if (loops < 0 || !std::isfinite(rate) || rate <= 0) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid loop count or rate in /sequence command");
+                return;
+            }
+            m_nextSequence = std::make_unique<DmxSequence>(id);
+            m_nextSequence->setLoops(loops);
+            m_nextSequence->setRate(rate);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/seq_step") ) {
+            float fade = 0;
+            float hold = 0;
+            m.ArgumentStream() >> fade >> hold >> osc::EndMessage;
+            if (!m_nextSequence) {
+                CuemsLogger::getLogger()->logWarning("OSC: /seq_step outside a /sequence bundle");
+                return;
+            }
+            if (!std::isfinite(fade) || !std::isfinite(hold) || fade < 0 || hold < 0) {
+                CuemsLogger::getLogger()->logWarning("OSC: Invalid fade or hold time in /seq_step command");
+                return;
+            }
+            m_nextSequence->addStep(std::round(1000 * std::min(fade, CuemsConstants::OSC_TIME_MAX_S)),
+                                    std::round(1000 * std::min(hold, CuemsConstants::OSC_TIME_MAX_S)));
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/cue_id") ) {
+            m_nextScene.m_cueId = readCueId(m);
+          } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/replace") ) {
+            m_nextScene.m_cueId = readCueId(m);
+            m_nextScene.m_replace = true;
           } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/fade_time") ) {
             float fade = 0;
             m.ArgumentStream() >> fade >> osc::EndMessage;
@@ -210,30 +2168,277 @@ void DmxPlayer::ProcessMessage( const osc::ReceivedMessage& m,
             const char *str = nullptr;
             m.ArgumentStream() >> str >> osc::EndMessage;
             std::string_view start_time(str);
+            m_nextScene.m_timed = true;
+            long int now = stampHead(m_nextScene.m_internalClock);
             if ("now" == start_time) {
-              m_nextScene.m_mtcStart = playHead;
+              m_nextScene.m_mtcStart = now;
             }
             else if ('+' == start_time[0]) {
-              m_nextScene.m_mtcStart = playHead + convertTime(start_time.substr(1));
+              m_nextScene.m_mtcStart = now + convertTime(start_time.substr(1));
             }
             else {
-              m_nextScene.m_mtcStart = std::max(playHead.load(), convertTime(start_time));
+              m_nextScene.m_mtcStart = std::max(now, convertTime(start_time));
             }
           } else if ( (string)m.AddressPattern() == (OscReceiver::oscAddress + "/start_offset") ) {
             int ofs = 0;
             m.ArgumentStream() >> ofs >> osc::EndMessage;
-            m_nextScene.m_mtcStart = playHead + ofs;
+            m_nextScene.m_mtcStart = stampHead(m_nextScene.m_internalClock) + ofs;
+            m_nextScene.m_timed = true;
           }
         }
 
     } catch ( osc::Exception& e ) {
         // any parsing errors such as unexpected argument types, or
         // missing arguments get thrown as exceptions.
+        m_ingestErrors.fetch_add(1, std::memory_order_relaxed);
         std::cout << "error while parsing message: "
             << m.AddressPattern() << ": " << e.what() << "\n";
     }
 }
 
+//////////////////////////////////////////////////////////
+// Page faults and context switches of one of our threads, from procfs
+// (getrusage() can only report the calling thread). -1 when unreadable.
+struct ThreadUsage
+{
+    int64_t minflt = -1;
+    int64_t majflt = -1;
+    int64_t nvcsw = -1;
+    int64_t nivcsw = -1;
+};
+
+static ThreadUsage readThreadUsage(pid_t tid)
+{
+    ThreadUsage usage;
+    std::string task = "/proc/self/task/" + std::to_string(tid);
+
+    // stat: minflt and majflt are fields 10 and 12; the command name
+    // (field 2) may contain spaces, so count from its closing parenthesis
+    std::ifstream stat(task + "/stat");
+    std::string line;
+    if (std::getline(stat, line)) {
+        auto pos = line.rfind(')');
+        if (pos != std::string::npos) {
+            std::istringstream fields(line.substr(pos + 1));
+            std::string skip;
+            for (int i = 3; i < 10 && fields >> skip; ++i) {}
+            int64_t cminflt = 0;
+            fields >> usage.minflt >> cminflt >> usage.majflt;
+        }
+    }
+
+    std::ifstream status(task + "/status");
+    while (std::getline(status, line)) {
+        if (0 == line.compare(0, 24, "voluntary_ctxt_switches:")) {
+            usage.nvcsw = std::stoll(line.substr(24));
+        } else if (0 == line.compare(0, 27, "nonvoluntary_ctxt_switches:")) {
+            usage.nivcsw = std::stoll(line.substr(27));
+        }
+    }
+    return usage;
+}
+
+//////////////////////////////////////////////////////////
+// Runs on the OSC thread, so its own CPU clock is the ingest CPU time.
+DmxPlayer::Stats DmxPlayer::collectStats()
+{
+    Stats stats;
+    auto cpuMs = [](clockid_t clock) {
+        timespec ts{};
+        clock_gettime(clock, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    };
+
+    stats.emplace_back("ingest_bundles", static_cast<int64_t>(m_ingestBundles.load()));
+    stats.emplace_back("ingest_messages", static_cast<int64_t>(m_ingestMessages.load()));
+    stats.emplace_back("ingest_errors", static_cast<int64_t>(m_ingestErrors.load()));
+    stats.emplace_back("ingest_cpu_ms", cpuMs(CLOCK_THREAD_CPUTIME_ID));
+    if (m_batchReceiver) {
+        auto udp = m_batchReceiver->metrics();
+        stats.emplace_back("udp_datagrams", static_cast<int64_t>(udp.datagrams));
+        stats.emplace_back("udp_batches", static_cast<int64_t>(udp.batches));
+        stats.emplace_back("udp_truncated", static_cast<int64_t>(udp.truncated));
+        stats.emplace_back("udp_kernel_drops", static_cast<int64_t>(udp.kernelDrops));
+        stats.emplace_back("udp_rcvbuf_bytes", static_cast<int64_t>(udp.rcvBufBytes));
+    }
+    if (m_renderCpuClockSet.load(std::memory_order_acquire)) {
+        stats.emplace_back("render_cpu_ms", cpuMs(m_renderCpuClock));
+    }
+    stats.emplace_back("frames_sent", static_cast<int64_t>(m_framesSent.load()));
+    stats.emplace_back("output_in_flight", static_cast<int64_t>(m_outputInFlight.load()));
+    stats.emplace_back("output_in_flight_peak", static_cast<int64_t>(m_outputInFlightPeak.exchange(0)));
+    stats.emplace_back("frames_coalesced", static_cast<int64_t>(m_framesCoalesced.load()));
+    stats.emplace_back("send_failures", static_cast<int64_t>(m_sendFailures.load()));
+    stats.emplace_back("rt_priority", static_cast<int64_t>(m_rtActivePriority.load()));
+    pid_t renderTid = m_renderTid.load();
+    if (0 != renderTid) {
+        auto usage = readThreadUsage(renderTid);
+        stats.emplace_back("render_minflt", usage.minflt);
+        stats.emplace_back("render_majflt", usage.majflt);
+        stats.emplace_back("render_nvcsw", usage.nvcsw);
+        stats.emplace_back("render_nivcsw", usage.nivcsw);
+    }
+    stats.emplace_back("render_log_dropped", static_cast<int64_t>(m_renderLog.dropped()));
+    if (AllocProbe::enabled) {
+        stats.emplace_back("render_allocs", static_cast<int64_t>(m_renderAllocs.load()));
+        stats.emplace_back("render_alloc_ticks", static_cast<int64_t>(m_renderAllocTicks.load()));
+    }
+    if (m_trace.isOpen()) {
+        stats.emplace_back("trace_records", static_cast<int64_t>(m_trace.records()));
+        stats.emplace_back("trace_dropped", static_cast<int64_t>(m_trace.dropped()));
+    }
+
+    // Lateness window: since the previous /stats
+    uint64_t ticks = m_ticks.exchange(0);
+    uint64_t lateSum = m_tickLateSumUs.exchange(0);
+    uint64_t lateMax = m_tickLateMaxUs.exchange(0);
+    stats.emplace_back("ticks", static_cast<int64_t>(ticks));
+    stats.emplace_back("tick_late_avg_ms", ticks ? lateSum / 1000.0 / ticks : 0.0);
+    stats.emplace_back("tick_late_max_ms", lateMax / 1000.0);
+
+    {
+        std::lock_guard guard(m_scenesMutex);
+        stats.emplace_back("queued_scenes", static_cast<int64_t>(m_scenes.size() + m_dueScenes.size()));
+        stats.emplace_back("queued_scene_bytes", static_cast<int64_t>(m_queuedSceneBytes));
+    }
+    stats.emplace_back("scenes_rejected", static_cast<int64_t>(m_scenesRejected.load()));
+    stats.emplace_back("scenes_dropped", static_cast<int64_t>(m_scenesDropped.load()));
+    stats.emplace_back("scenes_coalesced", static_cast<int64_t>(m_scenesCoalesced.load()));
+
+    auto pll = m_headTracker.metrics();
+    stats.emplace_back("pll_residual_ms", pll.residualMs);
+    stats.emplace_back("pll_avg_abs_residual_ms", pll.avgAbsResidualMs);
+    stats.emplace_back("pll_drift_ppm", pll.driftPpm);
+    stats.emplace_back("pll_relocks", static_cast<int64_t>(pll.relocks));
+    return stats;
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::logStats(const Stats &stats)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2) << "Stats:";
+    for (const auto &[key, value] : stats) {
+        os << " " << key << "=";
+        std::visit([&os](auto v) { os << v; }, value);
+    }
+    CuemsLogger::getLogger()->logInfo(os.str());
+}
+
+//////////////////////////////////////////////////////////
+// Reply to the sender of /stats with one "/stats" message of key, value
+// argument pairs (int64 counters, double measurements).
+void DmxPlayer::sendStats(const Stats &stats, const IpEndpointName &to)
+{
+    try {
+        char buffer[CuemsConstants::OSC_REPLY_BUFFER_SIZE];
+        osc::OutboundPacketStream p(buffer, sizeof(buffer));
+        p << osc::BeginMessage((OscReceiver::oscAddress + "/stats").c_str());
+        for (const auto &[key, value] : stats) {
+            p << key.c_str();
+            if (std::holds_alternative<int64_t>(value)) {
+                p << static_cast<osc::int64>(std::get<int64_t>(value));
+            } else {
+                p << std::get<double>(value);
+            }
+        }
+        p << osc::EndMessage;
+
+        UdpTransmitSocket socket(to);
+        socket.Send(p.Data(), p.Size());
+    } catch ( const std::exception &e ) {
+        CuemsLogger::getLogger()->logWarning(std::string("OSC: /stats reply failed: ") + e.what());
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Tell the sender of a bundle what the scene queue caps did with it:
+// /scene_queue <decision> <dropped> <queued scenes> <queued bytes> [<cue id>]
+void DmxPlayer::sendSceneQueueReply(Admission admission, int dropped, size_t scenes, size_t bytes,
+                                    const std::string &cueId, const IpEndpointName &to)
+{
+    const char *decision = "rejected";
+    if (Admission::DroppedOldest == admission) {
+        decision = "dropped_oldest";
+    } else if (Admission::Coalesced == admission) {
+        decision = "coalesced";
+    }
+    try {
+        char buffer[CuemsConstants::OSC_REPLY_BUFFER_SIZE];
+        osc::OutboundPacketStream p(buffer, sizeof(buffer));
+        p << osc::BeginMessage((OscReceiver::oscAddress + "/scene_queue").c_str())
+          << decision
+          << static_cast<osc::int32>(dropped)
+          << static_cast<osc::int32>(scenes)
+          << static_cast<osc::int64>(bytes);
+        if (!cueId.empty()) {
+            p << cueId.c_str();
+        }
+        p << osc::EndMessage;
+
+        UdpTransmitSocket socket(to);
+        socket.Send(p.Data(), p.Size());
+    } catch ( const std::exception &e ) {
+        CuemsLogger::getLogger()->logWarning(std::string("OSC: /scene_queue reply failed: ") + e.what());
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Reply to /get_state from the last published output state: a /state
+// header (frame, play-head, pending scenes, universe count, running fades)
+// followed by one /state/universe message per universe with its values as
+// a blob. Universes not known to the player are left out.
+void DmxPlayer::sendState(const std::vector<uint32_t> &universes, const IpEndpointName &to)
+{
+    const OutputState &state = m_stateBuffer.acquire();
+
+    std::vector<const OutputState::Universe *> selected;
+    if (universes.empty()) {
+        for (uint32_t i = 0; i < state.universeCount; ++i) {
+            selected.push_back(&state.universes[i]);
+        }
+    } else {
+        for (uint32_t univ_id : universes) {
+            if (const auto *entry = state.find(univ_id)) {
+                selected.push_back(entry);
+            }
+        }
+    }
+    int fades = 0;
+    for (const auto *entry : selected) {
+        fades += entry->fades;
+    }
+
+    try {
+        UdpTransmitSocket socket(to);
+        char buffer[CuemsConstants::OSC_REPLY_BUFFER_SIZE];
+
+        osc::OutboundPacketStream p(buffer, sizeof(buffer));
+        p << osc::BeginMessage((OscReceiver::oscAddress + "/state").c_str())
+          << static_cast<osc::int64>(state.frame)
+          << static_cast<osc::int64>(state.playHead)
+          << static_cast<osc::int32>(state.pendingScenes)
+          << static_cast<osc::int32>(selected.size())
+          << static_cast<osc::int32>(fades)
+          << osc::EndMessage;
+        socket.Send(p.Data(), p.Size());
+
+        for (const auto *entry : selected) {
+            osc::OutboundPacketStream u(buffer, sizeof(buffer));
+            u << osc::BeginMessage((OscReceiver::oscAddress + "/state/universe").c_str())
+              << static_cast<osc::int32>(entry->id)
+              << static_cast<osc::int32>(entry->state)
+              << static_cast<osc::int32>(entry->fades)
+              << static_cast<osc::int32>(entry->effects)
+              << osc::Blob(entry->values, sizeof(entry->values))
+              << osc::EndMessage;
+            socket.Send(u.Data(), u.Size());
+        }
+    } catch ( const std::exception &e ) {
+        CuemsLogger::getLogger()->logWarning(std::string("OSC: /get_state reply failed: ") + e.what());
+    }
+}
+
 //////////////////////////////////////////////////////////
 long int DmxPlayer::convertTime(const std::string_view &time)
 {
@@ -268,145 +2473,426 @@ long int DmxPlayer::convertTime(const std::string_view &time)
 
 //////////////////////////////////////////////////////////
 //static
+// I/O thread: hand a FetchDMX reply to the render thread
 void DmxPlayer::OnFetchDMX(DmxPlayer* dp, uint32_t univ_id, const ola::client::Result& result,
-    const ola::client::DMXMetadata& metadata, const ola::DmxBuffer& buffer)
+    const ola::client::DMXMetadata& /*metadata*/, const ola::DmxBuffer& buffer)
 {
-  std::cout
-    << "DmxPlayer::OnFetchDMX"
-    << " Result=" << result.Success()
-    << " id=" << metadata.universe << "/" << univ_id
-    << " buffer size=" << buffer.Size()
-    << " thread=" << std::this_thread::get_id()
-    << std::endl;
+  OutputMessage event{};
+  event.type = OutputMessage::Type::Fetched;
+  event.universe = univ_id;
+  event.generation = dp->m_outputGeneration.load(std::memory_order_relaxed);
+  event.ok = result.Success();
+  if (event.ok) {
+    unsigned int size = CuemsConstants::DMX_CHANNELS_PER_UNIVERSE;
+    buffer.Get(event.data, &size);
+    event.size = size;
+  }
+  dp->postOutputEvent(event);
+}
+
+//////////////////////////////////////////////////////////
+// The render thread. Ticks run on absolute deadlines, so the rate does not
+// drift with the time a tick takes, and their lateness is measured against
+// them for /stats; after a stall the schedule re-aligns to now. An idle
+// wait is cut short by wakeRender() and the schedule restarts from there.
+void DmxPlayer::renderLoop()
+{
+    m_renderTid = static_cast<pid_t>(syscall(SYS_gettid));
+    setupRealtime();
+
+    using Clock = chrono::steady_clock;
+    Clock::time_point deadline = Clock::now();
+    bool idle = true;
+    while (true) {
+        bool woken = false;
+        {
+            std::unique_lock lock(m_renderWakeMutex);
+            m_renderIdle = idle;
+            woken = m_renderWakeCv.wait_until(lock, deadline,
+                [this] { return (m_renderIdle && m_renderWake) || !m_running; });
+            m_renderWake = false;
+            m_renderIdle = false;
+        }
+        if (!m_running) {
+            break;
+        }
 
-  auto it = dp->m_activeUniverses.find(univ_id);
-  if (it != dp->m_activeUniverses.end()) {
-    if (result.Success()) {
-      it->second.m_state = 2;
-      it->second.m_channelsBuffer = buffer;
+        Clock::time_point start = Clock::now();
+        if (woken) {
+            deadline = start;
+        }
+        uint64_t late = std::max<int64_t>(0,
+            chrono::duration_cast<chrono::microseconds>(start - deadline).count());
+        m_ticks.fetch_add(1, std::memory_order_relaxed);
+        m_tickLateSumUs.fetch_add(late, std::memory_order_relaxed);
+        uint64_t prevMax = m_tickLateMaxUs.load(std::memory_order_relaxed);
+        while (late > prevMax && !m_tickLateMaxUs.compare_exchange_weak(prevMax, late)) {}
+
+        idle = !renderTick();
+
+        deadline += chrono::milliseconds(idle ? CuemsConstants::OLA_CALLBACK_TIMEOUT_IDLE_MS
+                                              : CuemsConstants::OLA_CALLBACK_TIMEOUT_MS);
+        Clock::time_point now = Clock::now();
+        if (deadline <= now) {
+            deadline = now + chrono::milliseconds(CuemsConstants::OLA_CALLBACK_TIMEOUT_MS);
+        }
     }
-    else {
-      it->second.m_state = 3;
+}
+
+//////////////////////////////////////////////////////////
+// OSC thread: new work for the render loop. An idle loop ticks at once and
+// goes back to the active rate; an active one is not disturbed.
+void DmxPlayer::wakeRender()
+{
+    bool idle = false;
+    {
+        std::lock_guard guard(m_renderWakeMutex);
+        m_renderWake = true;
+        idle = m_renderIdle;
+    }
+    if (idle) {
+        m_renderWakeCv.notify_one();
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Stop and join the render thread (not from the render thread itself,
+// where a signal handler may run)
+void DmxPlayer::stopRenderThread()
+{
+    {
+        std::lock_guard guard(m_renderWakeMutex);
+        m_running = false;
+    }
+    m_renderWakeCv.notify_all();
+    if (m_renderThread.joinable()) {
+        if (m_renderThread.get_id() == std::this_thread::get_id()) {
+            m_renderThread.detach();
+        }
+        else {
+            m_renderThread.join();
+        }
     }
-  }
 }
 
 //////////////////////////////////////////////////////////
-bool DmxPlayer::SendUniverseData(DmxPlayer* dp) {
-    // When not following MTC: still process queued scenes and send to OLA
-    // (e.g. "press Go" without timecode — scene is applied immediately)
-    if (!dp->followMTC) {
-      dp->playHead = 0;
-      dp->processScenes();
-      dp->updateActiveUniverses();
+// One render tick; true while there is work, i.e. the next one is due
+// in OLA_CALLBACK_TIMEOUT_MS
+bool DmxPlayer::renderTick() {
+    // Replay mode: ticks only come from /replay_tick
+    if (m_replay) {
+        runReplayTick();
+        return false;
+    }
+    // Output down: nothing goes out until run() has reconnected, and the
+    // first tick on the new connection resumes playback
+    if (!m_olaConnected) {
+        return false;
+    }
+
+    // Heap allocations made by this tick, when built with the probe
+    struct AllocScope {
+        DmxPlayer *dp;
+        explicit AllocScope(DmxPlayer *p) : dp(p) { AllocProbe::begin(); }
+        ~AllocScope() {
+            uint64_t n = AllocProbe::end();
+            if (0 < n) {
+                dp->m_renderAllocs.fetch_add(n, std::memory_order_relaxed);
+                dp->m_renderAllocTicks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    } allocScope(this);
+
+    int64_t tickUs = chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    m_renderNowUs = tickUs;
+    applyOutputEvents();
+    applyControlCommands();
+    if (!m_renderCpuClockSet.load(std::memory_order_relaxed)
+        && 0 == pthread_getcpuclockid(pthread_self(), &m_renderCpuClock)) {
+        m_renderCpuClockSet.store(true, std::memory_order_release);
+    }
+
+    bool rendered = false;
+
+    // When not following MTC the internal clock drives the play-head, so
+    // "press Go" without timecode still gets its delays and fades. It takes
+    // over from the current head (MTC's, or 0 at start): no jump.
+    if (!followMTC) {
+      if (!m_internalClock.load(std::memory_order_relaxed)) {
+        m_headTracker.reset();
+        m_clockOffsetUs.store(int64_t(playHead) * 1000 - tickUs, std::memory_order_relaxed);
+        m_internalClock.store(true, std::memory_order_release);
+        m_renderLog.post(RenderLog::Level::Info, "Play-head on the internal clock at %ld ms",
+            playHead.load());
+      }
+      playHead = (tickUs + m_clockOffsetUs.load(std::memory_order_relaxed)) / 1000;
+      processScenes();
+      updateActiveUniverses();
+      rendered = true;
     }
     // If we are receiving MTC and following it...
     // Or we are not receiving it and we do not stop on its lost
     // And we haven't reached the end of playing time...
     else {
-      bool timecode_running = dp->mtcReceiver.isTimecodeActive(); //isTimecodeRunning
+      bool timecode_running = mtcReceiver && mtcReceiver->isTimecodeActive(); //isTimecodeRunning
       if ( ( timecode_running ||
-              (dp->mtcSignalLost && !dp->stopOnMTCLost) )   ) {
+              (mtcSignalLost && !stopOnMTCLost) )   ) {
 
           // Check play control flags
           // If there is MTC signal and we haven't started, check it
           if ( timecode_running ) {
-              if ( !dp->mtcSignalStarted ) {
-                  CuemsLogger::getLogger()->logInfo("MTC -> Play started");
-                  dp->mtcSignalStarted = true;
+              if ( !mtcSignalStarted ) {
+                  m_renderLog.post(RenderLog::Level::Info, "MTC -> Play started");
+                  mtcSignalStarted = true;
               }
               else {
-                  if ( dp->mtcSignalLost ) {
-                      CuemsLogger::getLogger()->logInfo("MTC -> Play resumed");
+                  if ( mtcSignalLost ) {
+                      m_renderLog.post(RenderLog::Level::Info, "MTC -> Play resumed");
                   }
               }
 
               // Receiving MTC, means that signal is not lost anymore
-              dp->mtcSignalLost = false;
+              mtcSignalLost = false;
           }
 
-          dp->playHead = dp->mtcReceiver.estimatedCurrentHead()
-                       + dp->m_outputLatencyMs.load();
-          dp->processScenes();
-          dp->updateActiveUniverses();
+          // The raw MTC estimate jitters with quarter-frame arrival times;
+          // fades are computed from the PLL-smoothed, monotonic head instead.
+          long int head = m_headTracker.update(mtcReceiver->estimatedCurrentHead(), tickUs)
+                        + m_outputLatencyMs.load();
+          if (m_internalClock.exchange(false)) {
+              rebaseTimeline(head - playHead);
+          }
+          playHead = head;
+          processScenes();
+          updateActiveUniverses();
+          rendered = true;
       }
       else {
-          if ( ! timecode_running && dp->mtcSignalStarted && !dp->mtcSignalLost ) {
-              CuemsLogger::getLogger()->logInfo("MTC signal lost");
-              dp->mtcSignalLost = true;
+          if ( ! timecode_running && mtcSignalStarted && !mtcSignalLost ) {
+              m_renderLog.post(RenderLog::Level::Info, "MTC signal lost");
+              mtcSignalLost = true;
+              m_headTracker.reset();
           }
       }
     }
 
-    // Adaptive timer: switch between idle (200ms) and active (10ms) intervals
-    bool needsWork = dp->hasActiveWork();
-    if (needsWork && dp->m_isIdleTimer) {
-        dp->registerTimer(/*idle=*/false, /*fromCallback=*/true);
-        return false;  // cancel this repeating timeout; new one already registered
-    }
-    if (!needsWork && !dp->m_isIdleTimer) {
-        dp->registerTimer(/*idle=*/true, /*fromCallback=*/true);
-        return false;
-    }
+    // Patched output, also when paused: a reload or a blackout goes out
+    sendPatchFrames();
+    traceTick(rendered);
+    flushOutputRequests();
 
-    return true;
+    return hasActiveWork();
 }
 
 //////////////////////////////////////////////////////////
 void DmxPlayer::processScenes() {
-  std::lock_guard guard(m_scenesMutex);
-  for (auto it = m_scenes.begin(); it != m_scenes.end(); ) {
-    SceneTransitionInfo &sc = *it++;
-    if (sc.m_mtcStart > playHead + universeFetchLookAheadTime) {
-      // No more scenes to process now
-      break;
+  // The due scenes are taken out of the queue and applied without the lock,
+  // so the OSC thread only ever waits for the splices. While they are out
+  // they are not in the cue index: /cancel and re-firings of their cues are
+  // settled when they are put back.
+  uint32_t blackouts = 0;
+  {
+    std::lock_guard guard(m_scenesMutex);
+    auto due = m_scenes.begin();
+    for (; due != m_scenes.end() && due->m_mtcStart <= playHead + universeFetchLookAheadTime; ++due) {
+      forgetCue(*due);
     }
-    std::cout << "Processing scene transition at " << sc.m_mtcStart
-              << "  now = " << playHead
-              << "  fade = " << sc.m_fadeTime
-              << "  thread=" << std::this_thread::get_id()
-              << std::endl;
-    for (auto it_univ = sc.m_sceneValues.begin(); it_univ != sc.m_sceneValues.end();) {
-      uint32_t univ_id = it_univ->first;
+    m_dueScenes.splice(m_dueScenes.end(), m_scenes, m_scenes.begin(), due);
+    blackouts = m_blackoutRequests.load(std::memory_order_relaxed);
+    m_renderState.pendingScenes = m_scenes.size();
+  }
+  if (m_dueScenes.empty()) {
+    return;
+  }
+
+  for (auto &sc : m_dueScenes) {
+    m_renderLog.post(RenderLog::Level::Debug,
+        "Processing scene transition at %ld  now = %ld  fade = %d",
+        sc.m_mtcStart, playHead.load(), sc.m_fadeTime);
+    // Spans that are applied (or failed) are dropped; the rest stay for
+    // the next pass
+    auto span_out = sc.m_spans.begin();
+    for (auto it_span = sc.m_spans.begin(); it_span != sc.m_spans.end(); ++it_span) {
+      uint32_t univ_id = it_span->m_universe;
       bool remove = false;
-      auto &active_universe = m_activeUniverses[univ_id];
+      auto *slot = m_activeUniverses.acquire(univ_id);
+      if (slot == nullptr) {
+        // No free slot: the span waits until a universe retires
+        if (!m_universeSlotsFull) {
+          m_universeSlotsFull = true;
+          m_renderLog.post(RenderLog::Level::Warning,
+              "All %u universe slots in use, universe %u waits",
+              CuemsConstants::ACTIVE_UNIVERSE_SLOTS, univ_id);
+        }
+        *span_out++ = *it_span;
+        continue;
+      }
+      auto &active_universe = *slot;
       if (0 == active_universe.m_state) {
-        // Just created, init it first
-        active_universe.m_id = univ_id;
-        active_universe.m_state = 1;
-        m_olaWrapper->GetClient()->FetchDMX(univ_id, ola::NewSingleCallback(&DmxPlayer::OnFetchDMX, this, univ_id));
-        std::cout << "fetch requested for universe " << univ_id << std::endl;
+        // Just created, init it first (patched universes are ready at once)
+        fetchUniverse(active_universe);
       }
-      else if (2 == active_universe.m_state) {
+      if (2 == active_universe.m_state) {
         // Buffer is fetched, ready to go
         remove = true;
-        int c = 0;
-        for (auto it_val = it_univ->second.begin(); it_val != it_univ->second.end(); ++it_val) {
-          auto &trs = active_universe.m_channelTransitions[it_val->first];
-          trs.mtc0 = sc.m_mtcStart;
-          trs.mtc1 = sc.m_mtcStart + sc.m_fadeTime;
+        auto &transitions = active_universe.m_channelTransitions;
+        const uint8_t *current = active_universe.m_channelsBuffer.GetRaw();
+        unsigned int current_size = active_universe.m_channelsBuffer.Size();
+        const SceneChannel *ch = sc.m_channels.data() + it_span->m_begin;
+        const SceneChannel *ch_end = sc.m_channels.data() + it_span->m_end;
+        for (; ch != ch_end; ++ch) {
+          auto &trs = transitions.start(ch->m_channel);
+          trs.mtc0 = sc.m_mtcStart + ch->m_delay;
+          trs.mtc1 = trs.mtc0 + std::max(0, sc.m_fadeTime + ch->m_fadeOffset);
           // We transition from the curent channel value to the requested one
-          trs.val0 = active_universe.m_channelsBuffer.Get(it_val->first);
-          trs.val1 = it_val->second;
-          ++c;
+          trs.val0 = (ch->m_channel < current_size) ? current[ch->m_channel] : 0;
+          trs.val1 = ch->m_value;
+          trs.cue = sc.m_cueTag;
+        }
+        m_renderLog.post(RenderLog::Level::Debug, "  set channels: %u", it_span->m_end - it_span->m_begin);
+
+        // Effects take over at the scene start: stops and same-range
+        // replacements only end the running generators at that time.
+        for (const auto &stop : sc.m_effectStops) {
+          if (stop.m_universe != univ_id) continue;
+          for (auto &fx : active_universe.m_effects) {
+            if (stop.m_firstChannel < 0 || stop.m_firstChannel == fx.m_firstChannel) {
+              fx.m_mtcEnd = std::min(fx.m_mtcEnd, sc.m_mtcStart);
+            }
+          }
+        }
+        for (const auto &sfx : sc.m_effects) {
+          if (sfx.m_universe != univ_id) continue;
+          DmxEffect *replaced = nullptr;
+          for (auto &fx : active_universe.m_effects) {
+            if (fx.m_firstChannel == sfx.m_effect.m_firstChannel) {
+              fx.m_mtcEnd = std::min(fx.m_mtcEnd, sc.m_mtcStart);
+              replaced = &fx;
+            }
+          }
+          DmxEffect fx = sfx.m_effect;
+          fx.m_mtcStart = sc.m_mtcStart;
+          fx.m_cue = sc.m_cueTag;
+          if (0 < sfx.m_duration) {
+            fx.m_mtcEnd = sc.m_mtcStart + sfx.m_duration;
+          }
+          // Never grown past the room reserved up front: when it is full a
+          // replacement takes the slot of the effect it ends (up to the
+          // look-ahead early), any other effect is dropped
+          if (active_universe.m_effects.size() < CuemsConstants::EFFECTS_PER_UNIVERSE_MAX) {
+            active_universe.m_effects.push_back(fx);
+          }
+          else if (replaced != nullptr) {
+            *replaced = fx;
+          }
+          else {
+            m_renderLog.post(RenderLog::Level::Warning,
+                "Universe %u runs %u effects, effect at channel %d dropped",
+                univ_id, CuemsConstants::EFFECTS_PER_UNIVERSE_MAX, fx.m_firstChannel);
+          }
         }
-        std::cout << "  set channels: " << c << std::endl;
       }
       else if (3 == active_universe.m_state) {
-        std::cout << "Failed to fetch channels for universe " << univ_id
-                  << ", removing it" << std::endl;
+        m_renderLog.post(RenderLog::Level::Debug,
+            "Failed to fetch channels for universe %u, removing it", univ_id);
         remove = true;
       }
 
-      if (remove) {
-        it_univ = sc.m_sceneValues.erase(it_univ);
+      if (!remove) {
+        *span_out++ = *it_span;
       }
-      else {
-        ++it_univ;
+    }
+    sc.m_spans.erase(span_out, sc.m_spans.end());
+  }
+
+  std::lock_guard guard(m_scenesMutex);
+  // A /blackout cleared the queue meanwhile (and its byte count): nothing
+  // taken out goes back
+  bool cleared = blackouts != m_blackoutRequests.load(std::memory_order_relaxed);
+  for (auto it = m_dueScenes.begin(); it != m_dueScenes.end(); ) {
+    auto sc = it++;
+    bool keep = !cleared && !sc->m_spans.empty();
+    if (keep && !sc->m_cueId.empty()) {
+      // Still the cue's latest firing, unless it was cancelled or fired
+      // again while out of the queue
+      auto found = m_cues.find(sc->m_cueId);
+      keep = found != m_cues.end() && found->second.tag == sc->m_cueTag;
+      if (keep) {
+        found->second.scene = sc;
+        found->second.queued = true;
+      }
+    }
+    if (!keep) {
+      // Retired here, freed off the render thread by the OSC thread
+      // (clearRetiredScenes(), or the /blackout handler)
+      if (!cleared) {
+        m_queuedSceneBytes -= sc->m_bytes;
       }
+      sc->m_bytes = 0;
+      m_retiredScenes.splice(m_retiredScenes.end(), m_dueScenes, sc);
+    }
+  }
+  // Scenes still waiting for a universe go back in start time order, ahead
+  // of scenes queued at the same time while they were out
+  if (!m_dueScenes.empty()) {
+    if (m_scenes.empty() || m_dueScenes.back().m_mtcStart <= m_scenes.front().m_mtcStart) {
+      m_scenes.splice(m_scenes.begin(), m_dueScenes);
+    }
+    else {
+      m_dueScenes.merge(m_scenes, [](const SceneTransitionInfo &a, const SceneTransitionInfo &b) {
+        return a.m_mtcStart < b.m_mtcStart;
+      });
+      m_scenes.swap(m_dueScenes);
+    }
+  }
+  countPendingScenes();
+  m_renderState.pendingScenes = m_scenes.size();
+}
+
+//////////////////////////////////////////////////////////
+void DmxPlayer::fetchUniverse(ActiveUniverse &univ)
+{
+  // olad only holds physical universes: a patched one starts from the
+  // last frame the patch has for it, or blacked out
+  if (m_patch != nullptr && m_patch->isLogical(univ.m_id)) {
+    if (const uint8_t *frame = m_patch->frame(univ.m_id)) {
+      univ.m_channelsBuffer.Set(frame, PatchTable::CHANNELS);
+    }
+    else {
+      univ.m_channelsBuffer.Blackout();
     }
-    if (sc.m_sceneValues.empty()) {
-      it = m_scenes.erase(--it);
+    univ.m_state = 2;
+    return;
+  }
+  OutputMessage request;
+  request.type = OutputMessage::Type::Fetch;
+  request.universe = univ.m_id;
+  request.generation = m_renderGeneration;
+  if (!m_outputRequests.push(request)) {
+    return;         // still to fetch: tried again on the next tick
+  }
+  m_outputRequested = true;
+  univ.m_state = 1;
+  m_renderLog.post(RenderLog::Level::Debug, "fetch requested for universe %u", univ.m_id);
+}
+
+//////////////////////////////////////////////////////////
+// A master moved: universes it dims that were retired (at full, so olad
+// holds their rendered values) are fetched back to be sent scaled
+void DmxPlayer::wakeDimmedUniverses()
+{
+  for (size_t word = 0; word < m_outputUniverses.size(); ++word) {
+    for (uint64_t bits = m_outputUniverses[word]; bits != 0; bits &= bits - 1) {
+      uint32_t univ_id = word * 64 + __builtin_ctzll(bits);
+      if (m_masters.isFull(univ_id) || m_activeUniverses.find(univ_id) != nullptr) {
+        continue;
+      }
+      auto *slot = m_activeUniverses.acquire(univ_id);
+      if (slot == nullptr) {
+        return;     // retried on the next master change
+      }
+      fetchUniverse(*slot);
     }
   }
 }
@@ -414,135 +2900,230 @@ void DmxPlayer::processScenes() {
 //////////////////////////////////////////////////////////
 void DmxPlayer::updateActiveUniverses()
 {
-  std::lock_guard guard(m_universesMutex);
-  for (auto it = m_activeUniverses.begin(); it != m_activeUniverses.end();) {
-    auto &univ = it->second;
-    // skip non-ready universes
+  int64_t nowUs = m_renderNowUs;
+  if (m_masters.update(nowUs) || m_mastersChanged) {
+    m_mastersChanged = false;
+    wakeDimmedUniverses();
+  }
+  for (size_t index = 0; index < m_activeUniverses.size();) {
+    auto &univ = m_activeUniverses.at(index);
+    // skip non-ready universes; those still to fetch (a sequence's, or a
+    // fetch the output queue had no room for) are fetched here (scenes
+    // fetch theirs in processScenes())
     if (univ.m_state != 2) {
-      ++it;
+      if (0 == univ.m_state) {
+        fetchUniverse(univ);
+      }
+      ++index;
       continue;
     }
-    for (auto it_trs = univ.m_channelTransitions.begin(); it_trs != univ.m_channelTransitions.end();) {
-      auto &trs = it_trs->second;
+    // Finished transitions are swapped out of the active list in place
+    auto &transitions = univ.m_channelTransitions;
+    for (size_t i = 0; i < transitions.m_active.size();) {
+      uint16_t channel = transitions.m_active[i];
+      auto &trs = transitions.m_slots[channel];
       bool ch_remove = false;
       if (trs.mtc1 <= trs.mtc0) {
-        // Instant transition (fade time 0)
-        univ.m_channelsBuffer.SetChannel(it_trs->first, trs.val1);
-        ch_remove = true;
+        // Instant transition (fade time 0), held until its (fan) delay
+        if (playHead >= trs.mtc0) {
+          univ.m_channelsBuffer.SetChannel(channel, trs.val1);
+          ch_remove = true;
+        }
       } else {
         double ph = 1.0 * (playHead - trs.mtc0) / (trs.mtc1 - trs.mtc0);
         if (0.0 < ph) {
           if (1.0 > ph) {
             uint8_t v = std::round(trs.val0 + ph * (trs.val1 - trs.val0));
-            univ.m_channelsBuffer.SetChannel(it_trs->first, v);
+            univ.m_channelsBuffer.SetChannel(channel, v);
           }
           else {
-            univ.m_channelsBuffer.SetChannel(it_trs->first, trs.val1);
+            univ.m_channelsBuffer.SetChannel(channel, trs.val1);
             ch_remove = true;
           }
         }
       }
       if (ch_remove) {
-        it_trs = univ.m_channelTransitions.erase(it_trs);
+        trs.active = false;
+        transitions.m_active[i] = transitions.m_active.back();
+        transitions.m_active.pop_back();
       }
       else {
-        ++it_trs;
+        ++i;
+      }
+    }
+
+    // Effects are rendered on top of the fades, in the order they started
+    if (!univ.m_effects.empty()) {
+      uint8_t samples[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+      for (auto it_fx = univ.m_effects.begin(); it_fx != univ.m_effects.end();) {
+        if (playHead >= it_fx->m_mtcEnd) {
+          it_fx = univ.m_effects.erase(it_fx);
+          continue;
+        }
+        if (it_fx->isRunning(playHead)) {
+          it_fx->render(playHead, samples);
+          univ.m_channelsBuffer.SetRange(it_fx->m_firstChannel, samples, it_fx->m_channelCount);
+        }
+        ++it_fx;
       }
     }
 
-    if (m_olaConnected) {
-        m_olaWrapper->GetClient()->SendDMX(univ.m_id, univ.m_channelsBuffer, ola::client::SendDMXArgs());
+    // Sequences last: they own the channels they set while they run
+    if (0 < univ.m_sequences) {
+      renderSequences(univ);
+    }
+
+    // Publish the rendered frame and what is still fading, so a restarted
+    // player resumes from here
+    bool published = m_snapshot.publish(univ.m_id, playHead, univ.m_channelsBuffer.GetRaw(), univ.m_channelsBuffer.Size(),
+      [&univ](OutputSnapshot::Transition *out, size_t max) {
+        size_t n = 0;
+        for (uint16_t channel : univ.m_channelTransitions.m_active) {
+          if (n == max) {
+            break;
+          }
+          const auto &trs = univ.m_channelTransitions.m_slots[channel];
+          out[n++] = {trs.mtc0, trs.mtc1, channel, trs.val0, trs.val1};
+        }
+        return n;
+      });
+    if (!published && !m_snapshotFullWarned) {
+      m_snapshotFullWarned = true;
+      m_renderLog.post(RenderLog::Level::Warning,
+          "Snapshot: no free slot for universe %u, it will not be restored after a restart", univ.m_id);
+    }
+
+    // Fades advance on every tick, but the frame only goes out on this
+    // universe's next transmit slot. Slots advance by whole intervals so the
+    // average rate matches the cap; after a stall they re-align to now.
+    // While olad still holds OUTPUT_MAX_IN_FLIGHT frames of this universe
+    // the slot is skipped: the buffer stays dirty, so the newest frame goes
+    // out on the first slot after olad catches up and the stale ones never
+    // queue up behind it. A full output queue holds the frame back the same
+    // way.
+    univ.m_dirty = true;
+    if (nowUs >= univ.m_nextTxUs && CuemsConstants::OUTPUT_MAX_IN_FLIGHT <= univ.m_inFlight) {
+      m_framesCoalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (nowUs >= univ.m_nextTxUs && sendFrame(univ)) {
+      if (!m_firstFrameSent) {
+        m_firstFrameSent = true;
+        m_renderLog.post(RenderLog::Level::Info, "Startup: first DMX frame sent %lld ms after startup",
+            static_cast<long long>(chrono::duration_cast<chrono::milliseconds>(
+                chrono::steady_clock::now() - m_startupTime).count()));
+      }
+      univ.m_dirty = false;
+
+      int fps = universeFpsCap(univ.m_id);
+      if (0 < fps) {
+        int64_t interval = 1000000 / fps;
+        univ.m_nextTxUs += interval;
+        if (univ.m_nextTxUs <= nowUs) {
+          univ.m_nextTxUs = nowUs + interval;
+        }
+      }
     }
 
-    if (univ.m_channelTransitions.empty()) {
-      it = m_activeUniverses.erase(it);
-      std::cout << "removing universe " << univ.m_id << " from active universes (all done)" << std::endl;
+    // Keep a finished universe until its last frame has been transmitted,
+    // and while the masters dim it or a sequence runs on it
+    if (univ.m_channelTransitions.empty() && univ.m_effects.empty() && !univ.m_dirty
+        && m_masters.isFull(univ.m_id) && 0 == univ.m_sequences) {
+      m_renderLog.post(RenderLog::Level::Debug,
+          "removing universe %u from active universes (all done)", univ.m_id);
+      m_snapshot.release(univ.m_id);
+      m_snapshotFullWarned = false;
+      m_activeUniverses.releaseAt(index);
+      m_universeSlotsFull = false;
     }
     else {
-      ++it;
+      ++index;
     }
   }
+  finishSequences();
+
+  publishState();
 }
 
 //////////////////////////////////////////////////////////
-// Register a repeating timer on the OLA SelectServer.
-//
-// IMPORTANT: fromCallback controls whether we call RemoveTimeout().
-// When called from inside a repeating callback (SendUniverseData),
-// the caller MUST return false to cancel the old timer — calling
-// RemoveTimeout here would double-free the callback object since
-// OLA also removes it on false return. When called from outside
-// (e.g. switchToActiveTimer via Execute), we must call RemoveTimeout
-// explicitly because there is no return-false mechanism.
-void DmxPlayer::registerTimer(bool idle, bool fromCallback) {
-    if (!fromCallback && m_currentTimeoutId != ola::thread::INVALID_TIMEOUT && olaServer != nullptr) {
-        olaServer->RemoveTimeout(m_currentTimeoutId);
+// Refresh m_renderState from the active universes and hand it to the OSC
+// thread. Retired universes keep their last frame, which is still what
+// olad outputs.
+void DmxPlayer::publishState()
+{
+  for (const auto *active : m_activeUniverses) {
+    const auto &univ = *active;
+    auto *entry = m_renderState.universe(univ.m_id);
+    if (entry == nullptr) {
+      continue;     // table full: not reported
     }
+    entry->state = univ.m_state;
+    entry->fades = univ.m_channelTransitions.size();
+    entry->effects = univ.m_effects.size();
+    if (2 == univ.m_state) {
+      unsigned int size = std::min<unsigned int>(univ.m_channelsBuffer.Size(),
+                                                 CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+      if (m_masters.isFull(univ.m_id)) {
+        std::copy(univ.m_channelsBuffer.GetRaw(), univ.m_channelsBuffer.GetRaw() + size, entry->values);
+      }
+      else {
+        m_masters.apply(univ.m_id, univ.m_channelsBuffer.GetRaw(), entry->values, size);
+      }
+    }
+  }
 
-    unsigned int interval = idle
-        ? CuemsConstants::OLA_CALLBACK_TIMEOUT_IDLE_MS
-        : CuemsConstants::OLA_CALLBACK_TIMEOUT_MS;
-
-    m_isIdleTimer = idle;
-    m_currentTimeoutId = olaServer->RegisterRepeatingTimeout(
-        interval,
-        ola::NewCallback(&DmxPlayer::SendUniverseData, this));
+  ++m_renderState.frame;
+  m_renderState.playHead = playHead;
+  m_stateBuffer.publish(m_renderState);
 }
 
 //////////////////////////////////////////////////////////
 bool DmxPlayer::hasActiveWork() const {
-    return !m_scenes.empty() || !m_activeUniverses.empty();
-}
-
-//////////////////////////////////////////////////////////
-void DmxPlayer::switchToActiveTimer() {
-    if (m_isIdleTimer) {
-        registerTimer(/*idle=*/false, /*fromCallback=*/false);
-    }
+    return 0 != m_pendingScenes.load(std::memory_order_relaxed) || !m_activeUniverses.empty() || m_masters.fading() || m_patchPending
+        || !m_runningSequences.empty();
 }
 
 //////////////////////////////////////////////////////////
 bool DmxPlayer::setupOlaConnection() {
-    CuemsLogger::getLogger()->logInfo("Setting up OLA connection...");
-
-    // auto_start=false: connect only to an already-running olad; never fork a
-    // rogue `olad` (which would run as cuems without plugdev and be unable to
-    // drive USB DMX widgets). main() has already gated on olad reachability.
-    m_olaWrapper = std::make_unique<ola::client::OlaClientWrapper>(false);
-
-    if (!m_olaWrapper->Setup()) {
-        CuemsLogger::getLogger()->logError("OLA setup failed");
-        m_olaWrapper.reset();
-        return false;
-    }
-
-    olaServer = m_olaWrapper->GetSelectServer();
-    if (olaServer == nullptr) {
-        CuemsLogger::getLogger()->logError("OLA SelectServer is null");
-        m_olaWrapper.reset();
-        return false;
+    if (m_nullOutput) {
+        m_output = std::make_unique<NullDmxOutput>();
+    } else {
+        CuemsLogger::getLogger()->logInfo("Setting up OLA connection...");
+        m_output = std::make_unique<OlaDmxOutput>();
     }
 
     // Override the default close behavior (which just calls Terminate).
     // We set our flag first so the run() loop knows this is a disconnection.
-    m_olaWrapper->SetCloseCallback(
-        ola::NewCallback(this, &DmxPlayer::onOlaConnectionClosed));
+    if (!m_output->setup(ola::NewCallback(this, &DmxPlayer::onOlaConnectionClosed),
+                         ola::NewCallback(this, &DmxPlayer::onFrameDone))) {
+        m_output.reset();
+        return false;
+    }
+    olaServer = m_output->selectServer();
 
-    // Start in idle mode — switch to active when scenes arrive
-    registerTimer(/*idle=*/!hasActiveWork());
+    // Frames and fetches queued by the render thread
+    m_outputWakeDescriptor = std::make_unique<ola::io::UnmanagedFileDescriptor>(m_outputWakeFd);
+    m_outputWakeDescriptor->SetOnData(ola::NewCallback(this, &DmxPlayer::onOutputRequests));
+    olaServer->AddReadDescriptor(m_outputWakeDescriptor.get());
 
+    // A new generation: the render thread resumes playback on it
+    m_outputGeneration.fetch_add(1, std::memory_order_release);
     m_olaConnected = true;
-    CuemsLogger::getLogger()->logInfo("OLA connection established");
+    CuemsLogger::getLogger()->logInfo(std::string("DMX output established: ") + m_output->name());
     return true;
 }
 
 //////////////////////////////////////////////////////////
 void DmxPlayer::teardownOlaConnection() {
     m_olaConnected = false;
-    m_currentTimeoutId = ola::thread::INVALID_TIMEOUT;
-    m_isIdleTimer = false;
+    if (olaServer != nullptr && m_outputWakeDescriptor) {
+        olaServer->RemoveReadDescriptor(m_outputWakeDescriptor.get());
+    }
+    m_outputWakeDescriptor.reset();
+    // Events of this connection are of no use to the next one
+    m_ioBacklog.clear();
+    m_ioRetryPending = false;
     olaServer = nullptr;
-    m_olaWrapper.reset();
+    m_output.reset();
 }
 
 //////////////////////////////////////////////////////////
@@ -555,22 +3136,168 @@ void DmxPlayer::onOlaConnectionClosed() {
 }
 
 //////////////////////////////////////////////////////////
-void DmxPlayer::purgeStaleScenes() {
+// Render thread: carry playback over a reconnect. Fades are functions of
+// the play-head, so keeping the transitions and the recently due scenes is
+// enough for them to continue at the time-correct value. Only the fetch
+// state and the in-flight counts are invalid: what was queued for or
+// reported by the old connection is dropped.
+void DmxPlayer::resumeAfterReconnect() {
     long int now = playHead.load();
+    size_t dropped = 0;
 
     {
         std::lock_guard guard(m_scenesMutex);
-        m_scenes.remove_if([now](const SceneTransitionInfo &sc) {
-            return sc.m_mtcStart < now - 100;
+        size_t before = m_scenes.size();
+        m_scenes.remove_if([this, now](const SceneTransitionInfo &sc) {
+            if (sc.m_mtcStart + sc.m_fadeTime
+                < now - CuemsConstants::OLA_RECONNECT_SCENE_RETENTION_MS) {
+                forgetCue(sc);
+                m_queuedSceneBytes -= sc.m_bytes;
+                return true;
+            }
+            return false;
         });
+        dropped = before - m_scenes.size();
+        countPendingScenes();
     }
 
-    {
-        // Clear active universes — pending FetchDMX callbacks from the old
-        // connection will never fire, so entries stuck in state 1 must be reset.
-        // Universes will be re-fetched on the next processScenes() cycle.
-        std::lock_guard guard(m_universesMutex);
-        m_activeUniverses.clear();
+    // Sends of the old connection will never complete
+    m_outputInFlight = 0;
+    if (m_patch != nullptr) {
+        for (auto &phys : m_patch->physical()) {
+            phys.inFlight = 0;
+        }
+        m_patch->resend();
+    }
+
+    size_t resumed = 0;
+    for (auto *univ : m_activeUniverses) {
+        if (2 == univ->m_state) {
+            // Our buffer is what was on stage; olad may have lost it, so
+            // send a catch-up frame on the first tick
+            univ->m_dirty = true;
+            univ->m_nextTxUs = 0;
+            univ->m_inFlight = 0;
+            ++resumed;
+        }
+        else {
+            // Fetch pending or failed: fetch again on this tick
+            univ->m_state = 0;
+        }
+    }
+
+    if (resumed || dropped) {
+        m_renderLog.post(RenderLog::Level::Info, "Reconnect: resuming %zu universe(s), dropped %zu stale scene(s)",
+            resumed, dropped);
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Render thread: re-create the universes of the previous run from the snapshot. They are
+// ready at once (no FetchDMX): their buffers are the last frames we sent,
+// which is what is on stage, and they are marked dirty so that frame is
+// re-sent straight away even if olad restarted and lost it. Following MTC
+// the fades resume on the show's timecode; on the internal clock, which
+// restarted, they are moved onto the current head with the time they had
+// left.
+void DmxPlayer::restoreSnapshot() {
+    m_snapshotRestorePending = false;
+
+    long int head = playHead;
+    auto universes = m_snapshot.restore();
+    for (const auto &u : universes) {
+        auto *slot = m_activeUniverses.acquire(u.id);
+        if (slot == nullptr) {
+            m_renderLog.post(RenderLog::Level::Warning, "Snapshot: no free slot for universe %u", u.id);
+            continue;
+        }
+        auto &univ = *slot;
+        univ.m_channelsBuffer.Set(u.values, CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+        univ.m_state = 2;
+        univ.m_dirty = true;
+        univ.m_nextTxUs = 0;
+        univ.m_channelTransitions.clear();
+        int64_t shift = followMTC ? 0 : head - u.head;
+        for (const auto &t : u.transitions) {
+            if (t.channel >= CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+                continue;
+            }
+            auto &trs = univ.m_channelTransitions.start(t.channel);
+            trs.mtc0 = t.mtc0 + shift;
+            trs.mtc1 = t.mtc1 + shift;
+            trs.val0 = t.val0;
+            trs.val1 = t.val1;
+            trs.cue = 0;
+        }
+    }
+
+    if (!universes.empty()) {
+        m_renderLog.post(RenderLog::Level::Info, "Snapshot: restored %zu universe(s)", universes.size());
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Touch a stack region and a heap block once, so that with memory locked
+// the render thread does not fault pages in on its first deep call or
+// large allocation.
+static void __attribute__((noinline)) prefaultMemory()
+{
+    volatile char stack[CuemsConstants::RT_PREFAULT_STACK_BYTES];
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < sizeof(stack); i += page) {
+        stack[i] = 0;
+    }
+
+    char *heap = static_cast<char *>(malloc(CuemsConstants::RT_PREFAULT_HEAP_BYTES));
+    if (heap != nullptr) {
+        for (size_t i = 0; i < CuemsConstants::RT_PREFAULT_HEAP_BYTES; i += page) {
+            heap[i] = 0;
+        }
+        free(heap);   // stays in the arena: trimming is off
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Real-time render mode, applied to the calling (render) thread. Each step
+// that the system refuses (no CAP_SYS_NICE / rtprio or memlock limit, CPU
+// not available) is logged and skipped: the player still runs, just
+// without that guarantee.
+void DmxPlayer::setupRealtime()
+{
+    if (0 <= m_rtCpu) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(m_rtCpu, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (0 != err) {
+            CuemsLogger::getLogger()->logWarning("Realtime: cannot pin render thread to CPU "
+                + std::to_string(m_rtCpu) + ": " + std::strerror(err));
+        } else {
+            CuemsLogger::getLogger()->logInfo("Realtime: render thread pinned to CPU " + std::to_string(m_rtCpu));
+        }
+    }
+
+    if (0 < m_rtPriority) {
+        // Keep freed memory mapped (no trimming, no per-allocation mmap) so
+        // what gets locked and pre-faulted now is what the render loop reuses
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        if (0 != mlockall(MCL_CURRENT | MCL_FUTURE)) {
+            CuemsLogger::getLogger()->logWarning(std::string("Realtime: mlockall failed: ") + std::strerror(errno));
+        }
+        prefaultMemory();
+
+        sched_param param{};
+        param.sched_priority = m_rtPriority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (0 != err) {
+            CuemsLogger::getLogger()->logWarning("Realtime: SCHED_FIFO priority "
+                + std::to_string(m_rtPriority) + " refused: " + std::strerror(err));
+        } else {
+            m_rtActivePriority = m_rtPriority;
+            CuemsLogger::getLogger()->logInfo("Realtime: render thread on SCHED_FIFO priority "
+                + std::to_string(m_rtPriority));
+        }
     }
 }
 
@@ -587,6 +3314,10 @@ void DmxPlayer::run( void ) {
         "DMX output latency compensation = "
         + std::to_string(m_outputLatencyMs.load()) + " ms");
 
+    // Rendering runs on its own thread; this one is the output (I/O)
+    // thread, running the output's SelectServer and reconnecting it
+    m_renderThread = std::thread(&DmxPlayer::renderLoop, this);
+
     unsigned int reconnectDelay = CuemsConstants::OLA_RECONNECT_INITIAL_DELAY_MS;
 
     while (m_running) {
@@ -602,8 +3333,9 @@ void DmxPlayer::run( void ) {
         // Reset backoff on successful connection
         reconnectDelay = CuemsConstants::OLA_RECONNECT_INITIAL_DELAY_MS;
 
-        // Discard scenes queued during downtime and reset universe state
-        purgeStaleScenes();
+        // The render thread resumes playback (and restores the snapshot on
+        // the first connection) on its next tick: see applyOutputEvents()
+        wakeRender();
 
         CuemsLogger::getLogger()->logInfo("OLA SelectServer running");
         olaServer->Run();  // Blocks until Terminate() is called
@@ -620,5 +3352,5 @@ void DmxPlayer::run( void ) {
         teardownOlaConnection();
     }
 
-    m_running = false;
+    stopRenderThread();
 }
@@ -32,21 +32,28 @@
 
 //////////////////////////////////////////////////////////
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <memory>
 #include <vector>
 #include <list>
+#include <unordered_map>
 #include <iostream>
 #include <iomanip>
 #include <mutex>
+#include <thread>
+#include <ctime>
+#include <condition_variable>
+#include <variant>
 #include <rtmidi/RtMidi.h>
 
 #include <ola/DmxBuffer.h>
 #include <ola/client/ClientWrapper.h>
 #include <ola/Logging.h>
 #include <ola/Callback.h>
+#include <ola/io/Descriptor.h>
 #include <ola/io/SelectServer.h>
 
 #include "./mtcreceiver/mtcreceiver.h"
@@ -55,6 +62,20 @@
 #include "./cuemslogger/cuemslogger.h"
 #include "cuems_errors.h"
 #include "cuems_constants.h"
+#include "dmxeffect.h"
+#include "dmxsequence.h"
+#include "playheadtracker.h"
+#include "outputsnapshot.h"
+#include "outputstate.h"
+#include "outputmasters.h"
+#include "patchtable.h"
+#include "controlqueue.h"
+#include "outputqueue.h"
+#include "showtrace.h"
+#include "renderlog.h"
+#include "allocprobe.h"
+#include "dmxoutput.h"
+#include "oscbatchreceiver.h"
 
 //using namespace std;
 
@@ -64,12 +85,16 @@ class DmxPlayer : public OscReceiver
     // Public members
     public:
         //////////////////////////////////////////
-        // Constructors and destructors
+        // Constructors and destructors. Without mtcInput no MTC port is
+        // opened and the play-head only runs on the internal clock (tests).
         DmxPlayer(  int port = 8000,
                     const string oscRoute = "",
                     const bool stopOnLostFlag = true,
                     const bool followMTCFlag = false,
-                    const std::string &client_name = "DMX_Player"
+                    const std::string &client_name = "DMX_Player",
+                    const bool batchedOsc = true,
+                    const int oscRcvBufBytes = CuemsConstants::OSC_RCVBUF_DEFAULT,
+                    const bool mtcInput = true
                     );
         ~DmxPlayer( void );
         //////////////////////////////////////////
@@ -77,26 +102,102 @@ class DmxPlayer : public OscReceiver
         // OLA Methods
         void run( void );
         bool IsRunning() const { return m_running.load(); }
+        bool isOscListening() const { return m_oscListening; }
 
         // Set the DMX output-pipeline latency compensation in ms.
         // Values outside [0, 500] are clamped. Thread-safe (atomic).
         void setOutputLatencyMs(long ms);
 
+        // Cap the DMX transmit rate in frames/s, for every universe or for
+        // one universe (overrides the global cap). 0 means uncapped; values
+        // are clamped to [0, OUTPUT_FPS_MAX]. The global cap is thread-safe;
+        // a universe cap is queued for the render loop and must come from
+        // the OSC thread.
+        void setOutputFpsCap(int fps);
+        void setOutputFpsCap(uint32_t univ_id, int fps);
+
+        // Scene queue caps: scenes queued and bytes they hold (0 = no
+        // limit for either), and what a bundle that does not fit gets.
+        // Reject drops the new scene; DropOldest drops queued scenes from
+        // the earliest start on; Coalesce folds it into the scene queued
+        // just before it. Each decision is replied to the sender with
+        // /scene_queue. Thread-safe.
+        enum class SceneOverflow { Reject, DropOldest, Coalesce };
+        void setSceneQueueLimits(size_t maxScenes, size_t maxBytes, SceneOverflow policy);
+        static bool parseSceneOverflow(const std::string &name, SceneOverflow &policy);
+
+        // Map the persistent output snapshot. Universes found in it are
+        // restored when run() first connects to olad, then kept up to date
+        // by the render loop. Call before run().
+        bool setSnapshotFile(const std::string &path);
+
+        // Load the logical-to-physical patch table (see PatchTable). Also
+        // used by /patch_load; a file that fails to load leaves the current
+        // patch in place.
+        bool setPatchFile(const std::string &path);
+
+        // Record the show trace (OSC packets, render ticks, sent frames)
+        // into a ring file of regionBytes per writer thread. Call once,
+        // before run(); the OSC thread may already be receiving (packets
+        // before it are not recorded).
+        bool setTraceFile(const std::string &path, size_t regionBytes);
+
+        // Replay mode (virtual clock): the render timer no longer renders;
+        // each /replay_tick runs one tick at the play-head and time it
+        // carries, for tools/dmxreplay. Call before run().
+        void setReplay(bool replay) { m_replay = replay; }
+
+        // Every OSC packet goes through here; recorded to the trace before
+        // it is parsed
+        void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint) override;
+
+        // Process start reference for the time-to-first-DMX log line
+        void setStartupTime(std::chrono::steady_clock::time_point t) { m_startupTime = t; }
+
+        // Discard output instead of connecting to olad (load tests,
+        // benchmarks). Call before run().
+        void setNullOutput(bool null) { m_nullOutput = null; }
+
+        // Real-time render mode: the render thread started by run() goes
+        // under SCHED_FIFO at priority (0 = off, with memory locked and
+        // pre-faulted) and is pinned to cpu (-1 = no pinning). Call before
+        // run().
+        void setRealtime(int priority, int cpu) { m_rtPriority = priority; m_rtCpu = cpu; }
+
     protected:
         // MTC receiver object
-        MtcReceiver mtcReceiver;                        // Our MTC receiver object
+        std::unique_ptr<MtcReceiver> mtcReceiver;       // Our MTC receiver object, nullptr without MTC input
 
         // Playing head pointer
         static std::atomic<long int> playHead;          // Current playing head position in ms
+        PlayHeadTracker m_headTracker;                  // Smooths the MTC head (render thread)
 
         bool stopOnMTCLost = true;                      // Do we go on playing if we lost MTC?
         bool mtcSignalLost = false;                     // Flag to check MTC signal lost?
         bool mtcSignalStarted = false;                  // Flag to check MTC signal started?
         bool followMTC = false;                         // Do we follow MTC or paused
 
-        // OLA components
-        std::unique_ptr<ola::client::OlaClientWrapper> m_olaWrapper;
+        // DMX output backend (olad, or null for benchmarks) and its
+        // SelectServer, run by the output (I/O) thread: the thread in run()
+        std::unique_ptr<DmxOutput> m_output;
         ola::io::SelectServer *olaServer = nullptr;
+        bool m_nullOutput = false;
+
+        // The render thread hands frames and fetches to the I/O thread in
+        // m_outputRequests, waking it through m_outputWakeFd once per tick,
+        // and takes completions and fetched universes from m_outputEvents at
+        // the start of the next one. Every connection gets a new generation;
+        // messages of an older one are dropped on either side.
+        OutputQueue m_outputRequests;                    // render -> I/O
+        OutputQueue m_outputEvents;                      // I/O -> render
+        int m_outputWakeFd = -1;                         // eventfd
+        std::unique_ptr<ola::io::UnmanagedFileDescriptor> m_outputWakeDescriptor;   // I/O thread
+        std::atomic<uint32_t> m_outputGeneration{0};     // written by the I/O thread
+        uint32_t m_renderGeneration = 0;                 // render thread only
+        bool m_outputRequested = false;                  // render thread: wake the I/O thread
+        ola::DmxBuffer m_ioBuffer;                       // I/O thread
+        std::vector<OutputMessage> m_ioBacklog;          // I/O thread: events the queue had no room for
+        bool m_ioRetryPending = false;                   // I/O thread
 
         // OLA connection state
         std::atomic<bool> m_olaConnected{false};
@@ -109,20 +210,220 @@ class DmxPlayer : public OscReceiver
         // (~31 ms typical) and ArtNet (~44 ms typical).
         std::atomic<long int> m_outputLatencyMs{35};
 
-        // Adaptive timer state
-        ola::thread::timeout_id m_currentTimeoutId = ola::thread::INVALID_TIMEOUT;
-        bool m_isIdleTimer = false;
+        // Internal clock: drives the play-head while MTC is not followed,
+        // from the steady clock. The render thread starts it at the current
+        // head; on the way back to MTC what it timed is shifted onto the MTC
+        // head (rebaseTimeline()).
+        std::atomic<bool> m_internalClock{false};        // written by the render thread
+        std::atomic<int64_t> m_clockOffsetUs{0};         // head (µs) = steady clock (µs) + offset
+
+        // Transmit rate cap. Fades are still computed on every tick, but
+        // each universe is only sent to olad on its transmit slots: DMX512
+        // cannot carry more than ~44 frames/s, so extra frames are wasted RPC.
+        std::atomic<int> m_outputFpsCap{CuemsConstants::OUTPUT_FPS_DEFAULT};
+        // Per-universe caps, sorted by universe in a fixed table so setting
+        // one on the render thread never allocates
+        struct UniverseFpsCap
+        {
+            uint32_t universe;
+            int fps;
+        };
+        std::array<UniverseFpsCap, CuemsConstants::UNIVERSE_FPS_CAPS_MAX> m_universeFpsCaps;   // render thread
+        size_t m_universeFpsCapCount = 0;
+
+        // Grand master and submasters, applied to every frame sent. While a
+        // universe is dimmed it stays active, so moving a master back up
+        // still has its rendered values; universes retired at full are
+        // fetched back from olad when a master moves (m_outputUniverses).
+        OutputMasters m_masters;                         // render thread only
+        bool m_mastersChanged = false;                   // render thread only
+        // Universes sent at least once: one bit per universe id, render thread
+        std::array<uint64_t, (CuemsConstants::MAX_UNIVERSE_ID + 64) / 64> m_outputUniverses{};
+
+        // Patch table. Tables are loaded on the OSC thread and handed to the
+        // render loop through the control queue; the render thread only
+        // works on m_patch. A table is freed (by the OSC thread, on the next
+        // load) once a newer one has been installed. Cues, the masters and
+        // /get_state all see logical universes.
+        std::mutex m_patchMutex;                         // protects m_patchTables and m_patchPath
+        std::vector<std::unique_ptr<PatchTable>> m_patchTables;   // loaded, oldest first
+        std::string m_patchPath;
+        PatchTable *m_patch = nullptr;                   // render thread only; nullptr: no patch
+        std::atomic<PatchTable *> m_patchInstalled{nullptr};
+        bool m_patchPending = false;                     // render thread: physical frames held back
+
+        // Persistent output snapshot, written by the render loop
+        OutputSnapshot m_snapshot;
+        bool m_snapshotRestorePending = false;
+        bool m_snapshotFullWarned = false;               // render thread: until a slot is released
+
+        // Output state for /get_state: kept up to date by the render loop
+        // in m_renderState and handed to the OSC thread through the triple
+        // buffer after every tick
+        OutputState m_renderState;                      // render thread only
+        OutputStateBuffer m_stateBuffer;
+
+        // OSC thread -> render loop commands that change universe state.
+        // main() also queues the first patch table while the OSC receiver
+        // already runs, so pushes are serialized by m_controlPushMutex.
+        ControlQueue m_controlQueue;
+        std::mutex m_controlPushMutex;                  // producer side only; the render thread never takes it
+        // /blackout requests by generation: queued in order as a command,
+        // and caught up on every tick if the queue was full
+        std::atomic<uint32_t> m_blackoutRequests{0};
+        uint32_t m_blackoutsApplied = 0;                // render thread only
+
+        // Show trace, and the render tick's time (steady clock, or the
+        // replayed one under --replay)
+        ShowTrace m_trace;
+        int64_t m_renderNowUs = 0;                      // render thread only
+
+        // Replay mode: /replay_tick hands the tick to the render thread and
+        // waits (OSC thread) until it has run, then replies with the frames
+        // it sent
+        struct ReplayRequest
+        {
+          int64_t playHeadMs = 0;
+          int64_t nowUs = 0;
+          bool rendered = false;
+        };
+        bool m_replay = false;
+        std::mutex m_replayMutex;
+        std::condition_variable m_replayCv;
+        ReplayRequest m_replayRequest;                  // under m_replayMutex
+        uint64_t m_replayTicksPosted = 0;               // under m_replayMutex
+        uint64_t m_replayTicksDone = 0;                 // under m_replayMutex
+        uint32_t m_replayFrames = 0;                    // frames and their hash for the
+        uint64_t m_replayHash = 0;                      // current tick, render thread
+
+        // Ingest and render metrics reported by /stats. Counters are totals;
+        // tick lateness and the in-flight peak cover the window since the
+        // previous /stats.
+        std::atomic<uint64_t> m_ingestBundles{0};       // Top-level bundles committed
+        std::atomic<uint64_t> m_ingestMessages{0};
+        std::atomic<uint64_t> m_ingestErrors{0};        // OSC parse errors
+        std::atomic<uint64_t> m_framesSent{0};          // Universe frames handed to the output
+        std::atomic<uint32_t> m_outputInFlight{0};      // Not yet acknowledged by the output
+        std::atomic<uint32_t> m_outputInFlightPeak{0};
+        std::atomic<uint64_t> m_framesCoalesced{0};     // Due frames held back at the in-flight cap
+        std::atomic<uint64_t> m_sendFailures{0};        // Frames the output rejected or lost
+        std::atomic<uint64_t> m_scenesRejected{0};      // Scene queue overflow decisions
+        std::atomic<uint64_t> m_scenesDropped{0};
+        std::atomic<uint64_t> m_scenesCoalesced{0};
+        std::atomic<uint64_t> m_ticks{0};
+        std::atomic<uint64_t> m_tickLateSumUs{0};
+        std::atomic<uint64_t> m_tickLateMaxUs{0};
+        std::atomic<pid_t> m_renderTid{0};              // for the procfs fault / switch counters
+        std::atomic<uint64_t> m_renderAllocs{0};        // heap allocations during ticks (AllocProbe)
+        std::atomic<uint64_t> m_renderAllocTicks{0};    // ticks that allocated
+        clockid_t m_renderCpuClock = CLOCK_THREAD_CPUTIME_ID;   // set once, then published
+        std::atomic<bool> m_renderCpuClockSet{false};
+
+        // Batched OSC ingest; when set, the OscReceiver base socket is
+        // parked on an ephemeral port and this one owns the OSC port
+        std::unique_ptr<OscBatchReceiver> m_batchReceiver;
+        bool m_oscListening = true;
+
+        // Real-time render mode and the render thread's deferred log
+        int m_rtPriority = 0;
+        int m_rtCpu = -1;
+        std::atomic<int> m_rtActivePriority{0};         // 0 unless SCHED_FIFO was granted
+        RenderLog m_renderLog;
+
+        // Startup timing: the first transmitted frame is logged once
+        std::chrono::steady_clock::time_point m_startupTime = std::chrono::steady_clock::now();
+        bool m_firstFrameSent = false;                  // render thread only
+
+        // Render thread: ticks on its own deadline schedule, every
+        // OLA_CALLBACK_TIMEOUT_MS while there is work and every
+        // OLA_CALLBACK_TIMEOUT_IDLE_MS otherwise. The OSC thread wakes it
+        // out of an idle wait (wakeRender()).
+        std::thread m_renderThread;
+        std::mutex m_renderWakeMutex;
+        std::condition_variable m_renderWakeCv;
+        bool m_renderIdle = false;                      // under m_renderWakeMutex
+        bool m_renderWake = false;                      // under m_renderWakeMutex
 
         // Data structures for managing scene transitions
 
-        using FrameValues = std::map<uint16_t, uint8_t>;      // channel_id -> value
-        using SceneValues = std::map<uint32_t, FrameValues>;  // universe_id -> FrameValues
+        // One channel target of a scene. Fanned channels start m_delay ms
+        // after the scene and fade m_fadeOffset ms longer than it.
+        struct SceneChannel
+        {
+          uint32_t m_universe = 0;
+          uint16_t m_channel = 0;
+          uint8_t m_value = 0;
+          int32_t m_delay = 0;
+          int32_t m_fadeOffset = 0;
+
+          // Apply order: by universe, then channel
+          bool operator<(const SceneChannel &o) const {
+            return (m_universe != o.m_universe) ? (m_universe < o.m_universe)
+                                                : (m_channel < o.m_channel);
+          }
+        };
 
+        // The slice of SceneTransitionInfo::m_channels for one universe.
+        // Empty spans activate universes that only carry effects.
+        struct UniverseSpan
+        {
+          uint32_t m_universe = 0;
+          uint32_t m_begin = 0;
+          uint32_t m_end = 0;
+        };
+
+        struct SceneEffect
+        {
+          uint32_t m_universe = 0;
+          DmxEffect m_effect;
+          int m_duration = 0;           // ms, 0 runs until stopped
+        };
+
+        struct SceneEffectStop
+        {
+          uint32_t m_universe = 0;
+          int m_firstChannel = -1;      // -1 stops every effect in the universe
+        };
+
+        // Linear delay / fade spread over a channel range, in steps of
+        // m_group channels (one fixture). Negative spreads run the wave from
+        // the last step to the first.
+        struct SceneFan
+        {
+          uint32_t m_universe = 0;
+          int m_firstChannel = 0;
+          int m_channelCount = 0;
+          int m_delaySpread = 0;        // ms from the first step to the last
+          int m_fadeSpread = 0;         // ms
+          int m_group = 1;
+        };
+
+        // While a bundle is parsed m_channels collects targets in arrival
+        // order; compile() then sorts them by (universe, channel), keeps the
+        // last value sent for each channel, stamps the fan timings on them
+        // and builds m_spans, so applying a scene is a linear sweep over one
+        // array.
         struct SceneTransitionInfo
         {
-          SceneValues m_sceneValues;
+          std::vector<SceneChannel> m_channels;
+          std::vector<UniverseSpan> m_spans;              // universes still to apply, by id
+          std::vector<SceneEffect> m_effects;
+          std::vector<SceneEffectStop> m_effectStops;
+          std::vector<SceneFan> m_fans;                   // until compile()
           long int m_mtcStart = 0;
           int m_fadeTime = 0;
+          bool m_timed = false;                           // start set by /mtc_time or /start_offset
+          bool m_internalClock = false;                   // start stamped on the internal clock
+          std::string m_cueId;                            // /cue_id or /replace, empty for none
+          uint32_t m_cueTag = 0;                          // tags what this scene starts, 0 for none
+          bool m_replace = false;                         // /replace: stop what the cue started
+          size_t m_bytes = 0;                             // counted in m_queuedSceneBytes while queued
+
+          size_t footprint() const;                       // heap bytes held once queued
+          void compile();
+          void buildSpans();                              // m_channels must be sorted
+          void dropApplied();
+          int prune(const std::vector<SceneChannel> &newer);
         };
 
         struct ChannelTransition
@@ -131,44 +432,208 @@ class DmxPlayer : public OscReceiver
           long int mtc1 = 0;
           uint8_t val0 = 0;
           uint8_t val1 = 0;
+          bool active = false;
+          uint32_t cue = 0;             // m_cueTag of the scene that started it
         };
 
-        using ChannelTransitions = std::map<uint16_t, ChannelTransition>; // channel_id -> ChannelTransition
+        // Transition state indexed by channel, plus the list of channels
+        // with one running so a tick only visits those
+        struct ChannelTransitions
+        {
+          ChannelTransition m_slots[CuemsConstants::MAX_CHANNEL_ID + 1];
+          std::vector<uint16_t> m_active;                 // unordered
+
+          ChannelTransitions() { m_active.reserve(CuemsConstants::MAX_CHANNEL_ID + 1); }
+          ChannelTransition &start(uint16_t channel) {
+            ChannelTransition &trs = m_slots[channel];
+            if (!trs.active) {
+              trs.active = true;
+              m_active.push_back(channel);
+            }
+            return trs;
+          }
+          bool empty() const { return m_active.empty(); }
+          size_t size() const { return m_active.size(); }
+          void clear() {
+            for (uint16_t channel : m_active) {
+              m_slots[channel].active = false;
+            }
+            m_active.clear();
+          }
+        };
 
         struct ActiveUniverse
         {
           uint32_t  m_id;
           ola::DmxBuffer m_channelsBuffer;
+          ola::DmxBuffer m_outputBuffer;  // m_channelsBuffer through the masters
           int m_state = 0;
+          bool m_dirty = false;          // Rendered but not yet transmitted
+          int64_t m_nextTxUs = 0;        // Next transmit slot (steady clock, µs)
+          uint8_t m_inFlight = 0;        // Frames sent, not yet acknowledged
+          uint16_t m_sequences = 0;      // Running sequences with a track here
           ChannelTransitions m_channelTransitions;
+          std::vector<DmxEffect> m_effects;
+        };
+
+        // Fixed set of ActiveUniverse slots, allocated once with their DMX
+        // buffers and effect storage, so activating and retiring universes
+        // on the render thread never touches the heap. Iteration order is
+        // unspecified.
+        class UniverseTable
+        {
+          public:
+            UniverseTable();
+
+            ActiveUniverse *find(uint32_t id);
+            // The universe's slot, claimed (and reset) if needed; nullptr
+            // when every slot is in use
+            ActiveUniverse *acquire(uint32_t id);
+            void releaseAt(size_t index);              // swaps the last one in
+            void clear();
+
+            size_t size() const { return m_used.size(); }
+            bool empty() const { return m_used.empty(); }
+            ActiveUniverse &at(size_t index) { return *m_used[index]; }
+            std::vector<ActiveUniverse *>::iterator begin() { return m_used.begin(); }
+            std::vector<ActiveUniverse *>::iterator end() { return m_used.end(); }
+
+          private:
+            std::unique_ptr<ActiveUniverse[]> m_slots;
+            std::vector<ActiveUniverse *> m_used;
+            std::vector<ActiveUniverse *> m_free;
         };
 
         // Scene transition data
         std::list<SceneTransitionInfo> m_scenes;              // SceneTransitionInfo sorted by MTC
-        std::map<uint32_t, ActiveUniverse> m_activeUniverses; // universe_id -> ActiveUniverse
+        std::list<SceneTransitionInfo> m_retiredScenes;       // done, freed off the render thread
+        std::list<SceneTransitionInfo> m_dueScenes;           // render thread, out of m_scenes while applied;
+                                                              // spliced in and out under m_scenesMutex
+        std::atomic<size_t> m_pendingScenes{0};               // m_scenes + m_dueScenes, read unlocked
+        UniverseTable m_activeUniverses;                      // render thread only
+        bool m_universeSlotsFull = false;                     // render thread, warned once per episode
         SceneTransitionInfo m_nextScene;
-        std::mutex m_scenesMutex;     // protects m_scenes
-        std::mutex m_universesMutex; // protects m_activeUniverses
+        std::mutex m_scenesMutex;     // protects m_scenes, m_retiredScenes, m_cues, the queue caps and
+                                      // the membership of m_dueScenes
+
+        // Scene queue caps and accounting (m_scenesMutex): the footprint of
+        // every queued scene is counted when it is queued or edited
+        size_t m_maxQueuedScenes = CuemsConstants::SCENE_QUEUE_MAX_SCENES_DEFAULT;
+        size_t m_maxQueuedSceneBytes = static_cast<size_t>(CuemsConstants::SCENE_QUEUE_MAX_MB_DEFAULT) * 1024 * 1024;
+        SceneOverflow m_sceneOverflow = SceneOverflow::Reject;
+        size_t m_queuedSceneBytes = 0;
+        bool m_sceneQueueFull = false;                  // warned once per episode
+
+        // Cue index: /cue_id -> the tag of its latest firing and its scene.
+        // Each firing gets a new tag, so stopping what an older one started
+        // never touches a newer one. The scene iterator is only valid while
+        // queued is set: processScenes() clears it while the scene is out
+        // of the queue, and sets it again if the scene goes back.
+        struct CueEntry
+        {
+          uint32_t tag = 0;
+          std::list<SceneTransitionInfo>::iterator scene;
+          bool queued = false;
+        };
+        std::unordered_map<std::string, CueEntry> m_cues;
+        uint32_t m_lastCueTag = 0;
+
+        // Sequences: defined, compiled and owned by the OSC thread; started,
+        // stopped and rendered by the render thread through the control
+        // queue. A replaced definition is kept until it is idle().
+        std::unordered_map<std::string, std::unique_ptr<DmxSequence>> m_sequences;   // OSC thread
+        std::vector<std::unique_ptr<DmxSequence>> m_retiredSequences;                // OSC thread
+        std::unique_ptr<DmxSequence> m_nextSequence;     // OSC thread, while a /sequence bundle is parsed
+        std::vector<DmxSequence *> m_runningSequences;   // render thread only
 
     protected:
-        static bool SendUniverseData(   DmxPlayer* dp);
+        void renderLoop();                               // render thread
+        bool renderTick();                               // render thread; false when idle
+        void wakeRender();                               // OSC thread
+        void stopRenderThread();
         static void OnFetchDMX(DmxPlayer* dp, uint32_t univ_id,
             const ola::client::Result&, const ola::client::DMXMetadata&, const ola::DmxBuffer&);
 
+        bool postControl(const ControlCommand &command); // OSC thread, main()
+        void applyControlCommands();
+        void setUniverseFpsCap(uint32_t universe, int fps);   // render thread
+        int universeFpsCap(uint32_t universe) const;           // render thread
+        void blackoutUniverses();
+        bool sendFrame(ActiveUniverse &univ);
+        bool transmit(uint32_t universe, const ola::DmxBuffer &frame);
+        void installPatch(PatchTable *table);            // render thread
+        void sendPatchFrames();                          // render thread
+        void traceTick(bool rendered);
+        void replayTick(int64_t playHeadMs, int64_t nowUs, bool rendered);   // render thread
+        void runReplayTick();                            // render thread
+        void postReplayTick(int64_t playHeadMs, int64_t nowUs, bool rendered,
+                            const IpEndpointName &to);                       // OSC thread
         void processScenes();
+        // m_scenesMutex must be held for these
+        std::list<SceneTransitionInfo>::iterator insertScene(SceneTransitionInfo &&scene, int &pruned);
+        uint32_t fireCue(SceneTransitionInfo &scene);
+        bool cancelCue(const std::string &cueId, uint32_t &tag);
+        void forgetCue(const SceneTransitionInfo &scene);
+        void countScene(SceneTransitionInfo &scene);
+        void countPendingScenes();
+        std::list<SceneTransitionInfo>::iterator eraseScene(std::list<SceneTransitionInfo>::iterator it);
+        enum class Admission { Fits, Rejected, DroppedOldest, Coalesced };
+        Admission admitScene(SceneTransitionInfo &scene, int &dropped, int &pruned, bool &full);
+        void clearRetiredScenes();
+
+        void stopCue(uint32_t tag);                      // render thread
+        long int stampHead(bool &internal) const;        // OSC thread
+        void addFrameRun(uint32_t universe, int start,
+                         const uint8_t *values, int count);                  // OSC thread
+
+        // Sequences
+        void defineSequence();                           // OSC thread
+        bool postSequence(ControlCommand &command);      // OSC thread
+        void clearRetiredSequences();                    // OSC thread
+        void startSequence(DmxSequence *seq, long int head, int loops);   // render thread
+        void stopSequence(DmxSequence *seq);             // render thread
+        void renderSequences(ActiveUniverse &univ);      // render thread
+        void finishSequences();                          // render thread
+        void rebaseTimeline(long int deltaMs);           // render thread
+
+        // Masters: checked and queued from the OSC thread
+        void setMasterLevel(unsigned int master, float level, float fadeSeconds);
+        void assignSubmaster(unsigned int sub, uint32_t univ_id, int first, int count, bool on);
+        void wakeDimmedUniverses();                      // render thread
+        void fetchUniverse(ActiveUniverse &univ);        // render thread
         void updateActiveUniverses();
+        void restoreSnapshot();
+        void setupRealtime();
         long int convertTime(const std::string_view &time);
+        using StatValue = std::variant<int64_t, double>;
+        using Stats = std::vector<std::pair<std::string, StatValue>>;
+        Stats collectStats();                            // OSC thread
+        void logStats(const Stats &stats);
+        void sendStats(const Stats &stats, const IpEndpointName &to);
+        void publishState();                             // render thread
+        void sendState(const std::vector<uint32_t> &universes, const IpEndpointName &to);
+        void sendSceneQueueReply(Admission admission, int dropped, size_t scenes, size_t bytes,
+                                 const std::string &cueId, const IpEndpointName &to);
 
-        // Adaptive timer management
-        void registerTimer(bool idle, bool fromCallback = false);
         bool hasActiveWork() const;
-        void switchToActiveTimer();
+
+        // Render thread side of the output
+        void applyOutputEvents();
+        void frameDone(uint32_t universe, bool ok);
+        void universeFetched(const OutputMessage &event);
+        void flushOutputRequests();
+
+        // I/O thread side of the output
+        void onOutputRequests();
+        void onFrameDone(uint32_t universe, bool ok);
+        void postOutputEvent(const OutputMessage &event);
+        void retryOutputEvents();
 
         // OLA connection management
         bool setupOlaConnection();
         void teardownOlaConnection();
         void onOlaConnectionClosed();
-        void purgeStaleScenes();
+        void resumeAfterReconnect();
 
         long int startTimeStamp;
         // Start fetching universe data before transition start time
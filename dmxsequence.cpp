@@ -0,0 +1,218 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX looping sequence code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "dmxsequence.h"
+#include "cuems_constants.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+//////////////////////////////////////////////////////////
+void DmxSequence::addStep(int fadeMs, int holdMs)
+{
+    int64_t start = m_stepStart.empty() ? 0 : m_length;
+    m_stepStart.push_back(start);
+    m_stepFade.push_back(fadeMs);
+    m_length = start + fadeMs + holdMs;
+}
+
+//////////////////////////////////////////////////////////
+bool DmxSequence::addValue(uint32_t universe, uint16_t channel, uint8_t value)
+{
+    if (m_stepStart.empty()) {
+        return false;
+    }
+    m_input.push_back({universe, channel, value, static_cast<uint32_t>(m_stepStart.size() - 1)});
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+// A channel keeps its value through the steps that do not set it; before
+// the first step that sets it, it holds the value it had when the
+// sequence started (first loop) or its value at the end of the loop.
+bool DmxSequence::compile(std::string &error)
+{
+    size_t steps = m_stepStart.size();
+    if (0 == steps || steps > CuemsConstants::SEQUENCE_MAX_STEPS) {
+        error = "a sequence needs 1 to " + std::to_string(CuemsConstants::SEQUENCE_MAX_STEPS) + " steps";
+        return false;
+    }
+    for (size_t k = 0; k < steps; ++k) {
+        int64_t end = (k + 1 < steps) ? m_stepStart[k + 1] : m_length;
+        if (m_stepFade[k] < 0 || end - m_stepStart[k] < m_stepFade[k] || end <= m_stepStart[k]) {
+            error = "step " + std::to_string(k + 1) + " has no duration";
+            return false;
+        }
+    }
+    if (m_input.empty()) {
+        error = "no channel values";
+        return false;
+    }
+
+    // Channels by universe, then channel
+    std::vector<std::pair<uint32_t, uint16_t>> keys;
+    keys.reserve(m_input.size());
+    for (const auto &v : m_input) {
+        keys.emplace_back(v.universe, v.channel);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    size_t count = keys.size();
+
+    m_channels.resize(count);
+    m_tracks.clear();
+    for (size_t c = 0; c < count; ++c) {
+        m_channels[c] = keys[c].second;
+        if (m_tracks.empty() || m_tracks.back().universe != keys[c].first) {
+            Track track;
+            track.universe = keys[c].first;
+            track.begin = c;
+            m_tracks.push_back(track);
+        }
+        m_tracks.back().end = c + 1;
+    }
+
+    // Values set at each step (the last one sent wins), then tracked
+    std::vector<int16_t> set(steps * count, -1);
+    for (const auto &v : m_input) {
+        size_t c = std::lower_bound(keys.begin(), keys.end(), std::make_pair(v.universe, v.channel)) - keys.begin();
+        set[v.step * count + c] = v.value;
+    }
+    m_values.assign(steps * count, 0);
+    m_firstStep.assign(count, steps);
+    for (size_t k = 0; k < steps; ++k) {
+        for (size_t c = 0; c < count; ++c) {
+            int16_t value = set[k * count + c];
+            if (0 <= value) {
+                m_values[k * count + c] = value;
+                m_firstStep[c] = std::min<uint32_t>(m_firstStep[c], k);
+            }
+            else if (0 < k) {
+                m_values[k * count + c] = m_values[(k - 1) * count + c];
+            }
+        }
+    }
+    for (size_t c = 0; c < count; ++c) {
+        for (size_t k = 0; k < m_firstStep[c]; ++k) {
+            m_values[k * count + c] = m_values[(steps - 1) * count + c];
+        }
+    }
+
+    m_start.assign(count, 0);
+    m_input.clear();
+    m_input.shrink_to_fit();
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void DmxSequence::start(long int head, int loops)
+{
+    m_originHead = head;
+    m_originPosition = 0;
+    m_runLoops = (loops < 0) ? m_loops : loops;
+    for (auto &track : m_tracks) {
+        track.captured = false;
+    }
+    m_running.store(true, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////
+// A running sequence goes on from where it is at the new rate
+void DmxSequence::setRate(long int head, double rate, bool running)
+{
+    if (running) {
+        m_originPosition = position(head);
+        m_originHead = head;
+    }
+    m_rate = rate;
+}
+
+//////////////////////////////////////////////////////////
+double DmxSequence::position(long int head) const
+{
+    return std::max(0.0, m_originPosition + (head - m_originHead) * m_rate);
+}
+
+//////////////////////////////////////////////////////////
+bool DmxSequence::finished(long int head) const
+{
+    return 0 < m_runLoops && position(head) >= double(m_runLoops) * m_length;
+}
+
+//////////////////////////////////////////////////////////
+uint8_t DmxSequence::valueAt(long int loop, long int step, uint32_t c) const
+{
+    if (loop < 0 || (0 == loop && step < static_cast<long int>(m_firstStep[c]))) {
+        return m_start[c];
+    }
+    return m_values[step * m_channels.size() + c];
+}
+
+//////////////////////////////////////////////////////////
+void DmxSequence::render(Track &track, long int head, uint8_t *buffer, size_t size)
+{
+    if (!track.captured) {
+        for (uint32_t c = track.begin; c < track.end; ++c) {
+            m_start[c] = (m_channels[c] < size) ? buffer[m_channels[c]] : 0;
+        }
+        track.captured = true;
+    }
+
+    // Loop and step for the play-head; a finished sequence holds its end
+    double pos = position(head);
+    long int loop = static_cast<long int>(pos / m_length);
+    double inLoop = pos - double(loop) * m_length;
+    if (0 < m_runLoops && loop >= m_runLoops) {
+        loop = m_runLoops - 1;
+        inLoop = m_length;
+    }
+    long int step = std::upper_bound(m_stepStart.begin(), m_stepStart.end(), inLoop,
+        [](double v, int64_t start) { return v < start; }) - m_stepStart.begin() - 1;
+    double t = inLoop - m_stepStart[step];
+    int32_t fade = m_stepFade[step];
+    double ph = (0 < fade && t < fade) ? t / fade : 1.0;
+
+    long int prevLoop = (0 < step) ? loop : loop - 1;
+    long int prevStep = (0 < step) ? step - 1 : static_cast<long int>(m_stepStart.size()) - 1;
+    for (uint32_t c = track.begin; c < track.end; ++c) {
+        uint16_t channel = m_channels[c];
+        if (channel >= size) {
+            continue;
+        }
+        uint8_t cur = valueAt(loop, step, c);
+        if (1.0 <= ph) {
+            buffer[channel] = cur;
+        }
+        else {
+            uint8_t prev = valueAt(prevLoop, prevStep, c);
+            buffer[channel] = std::lround(prev + ph * (cur - prev));
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX looping sequence header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef DMXSEQUENCE_H
+#define DMXSEQUENCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////
+// A looping sequence of steps defined once by /sequence. Each step sets
+// some channels, fading to them in its fade time and holding them for its
+// hold time; channels a step does not set keep their previous value. The
+// position in the sequence is a function of the play-head, so stepping
+// is exact and costs no OSC traffic:
+//
+//   position = origin position + (playHead - origin head) * rate
+//
+// compile() turns the steps into one value table (every channel of the
+// sequence at every step) and one track per universe, so a tick renders a
+// universe with a lookup of the current step and one pass over its track.
+//
+// Definition methods run on the OSC thread, before the sequence is handed
+// to the render thread; playback methods run on the render thread only.
+class DmxSequence
+{
+    public:
+        // The channels of one universe: [begin, end) of m_channels
+        struct Track
+        {
+            uint32_t universe = 0;
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            bool captured = false;      // start values taken (render thread)
+            bool attached = false;      // holds an active universe (DmxPlayer)
+        };
+
+        explicit DmxSequence(const std::string &id) : m_id(id) {}
+
+        // Definition (OSC thread)
+        void addStep(int fadeMs, int holdMs);
+        bool addValue(uint32_t universe, uint16_t channel, uint8_t value);   // false before a step
+        void setLoops(int loops) { m_loops = loops; }
+        void setRate(double rate) { m_rate = rate; }
+        bool compile(std::string &error);
+
+        const std::string &id() const { return m_id; }
+        size_t stepCount() const { return m_stepStart.size(); }
+        std::vector<Track> &tracks() { return m_tracks; }
+
+        // Playback (render thread). loops 0 runs until stopped, < 0 keeps
+        // the defined count.
+        void start(long int head, int loops);
+        void setRate(long int head, double rate, bool running);
+        void shift(long int deltaMs) { m_originHead += deltaMs; }
+        bool finished(long int head) const;
+
+        // Write the track's channels for the play-head into a universe
+        // buffer; the first call after start() takes the buffer's values
+        // as the values the first steps fade from
+        void render(Track &track, long int head, uint8_t *buffer, size_t size);
+
+        // Lifetime between the threads: the OSC thread counts the commands
+        // it posts for the sequence, the render thread those it applied,
+        // and a replaced definition is freed once idle
+        uint32_t m_commandsPosted = 0;                  // OSC thread
+        std::atomic<uint32_t> m_commandsApplied{0};     // render thread
+        std::atomic<bool> m_running{false};             // render thread
+        bool idle() const {
+            return m_commandsApplied.load(std::memory_order_acquire) == m_commandsPosted
+                && !m_running.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct StepValue
+        {
+            uint32_t universe;
+            uint16_t channel;
+            uint8_t value;
+            uint32_t step;
+        };
+
+        double position(long int head) const;
+        uint8_t valueAt(long int loop, long int step, uint32_t c) const;
+
+        std::string m_id;
+        std::vector<StepValue> m_input;     // until compile()
+        std::vector<int64_t> m_stepStart;   // ms from the loop start
+        std::vector<int32_t> m_stepFade;    // ms
+        int64_t m_length = 0;               // ms per loop
+        int m_loops = 0;                    // defined count, 0: forever
+
+        std::vector<uint16_t> m_channels;   // by track, then channel
+        std::vector<Track> m_tracks;        // sorted by universe
+        std::vector<uint8_t> m_values;      // step * channels + channel, tracked
+        std::vector<uint32_t> m_firstStep;  // per channel: first step that sets it
+        std::vector<uint8_t> m_start;       // per channel: value when started
+
+        // Playback state (render thread)
+        double m_rate = 1.0;
+        long int m_originHead = 0;
+        double m_originPosition = 0;        // ms into the sequence at m_originHead
+        int m_runLoops = 0;
+};
+
+#endif // DMXSEQUENCE_H
@@ -36,6 +36,15 @@
 #include <cstdlib>
 #include <rtmidi/RtMidi.h>
 #include <memory>
+#include <future>
+#include <vector>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <alsa/asoundlib.h>
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -50,6 +59,9 @@ CuemsLogger* logger = NULL;
 // Main application function
 int main( int argc, char *argv[] ) {
 
+    // Reference for the per-phase startup timings (time-to-first-DMX)
+    const auto startupTime = std::chrono::steady_clock::now();
+
     // SIGTERM catcher
     signal(SIGTERM, sigTermHandler);
     signal(SIGUSR1, sigUsr1Handler);
@@ -178,6 +190,206 @@ int main( int argc, char *argv[] ) {
         }
     }
 
+    // --max-fps <int> : DMX transmit rate cap per universe in frames/s
+    // (0 = uncapped). Sentinel -1 means "no override, keep the default".
+    int maxFps = -1;
+    if ( argParser->optionExists("--max-fps") ) {
+        std::string fpsParam = argParser->getParam("--max-fps");
+        try {
+            maxFps = std::stoi(fpsParam);
+        } catch ( const std::exception& e ) {
+            std::cout << "Invalid integer after --max-fps: "
+                      << fpsParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --max-scenes <n> : scenes queued at most (0 = no limit).
+    // --max-scene-mb <n> : MiB queued scenes may hold (0 = no limit).
+    // --scene-overflow <reject|drop-oldest|coalesce> : what a scene past
+    // either cap gets.
+    long maxScenes = CuemsConstants::SCENE_QUEUE_MAX_SCENES_DEFAULT;
+    int maxSceneMb = CuemsConstants::SCENE_QUEUE_MAX_MB_DEFAULT;
+    DmxPlayer::SceneOverflow sceneOverflow = DmxPlayer::SceneOverflow::Reject;
+    if ( argParser->optionExists("--max-scenes") ) {
+        std::string scenesParam = argParser->getParam("--max-scenes");
+        try {
+            maxScenes = std::stol(scenesParam);
+        } catch ( const std::exception& e ) {
+            maxScenes = -1;
+        }
+        if ( maxScenes < 0 ) {
+            std::cout << "Invalid count after --max-scenes: "
+                      << scenesParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+    if ( argParser->optionExists("--max-scene-mb") ) {
+        std::string mbParam = argParser->getParam("--max-scene-mb");
+        try {
+            maxSceneMb = std::stoi(mbParam);
+        } catch ( const std::exception& e ) {
+            maxSceneMb = -1;
+        }
+        if ( maxSceneMb < 0 || maxSceneMb > CuemsConstants::SCENE_QUEUE_MAX_MB_MAX ) {
+            std::cout << "Invalid size after --max-scene-mb (0-"
+                      << CuemsConstants::SCENE_QUEUE_MAX_MB_MAX << "): " << mbParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+    if ( argParser->optionExists("--scene-overflow") ) {
+        std::string policyParam = argParser->getParam("--scene-overflow");
+        if ( !DmxPlayer::parseSceneOverflow(policyParam, sceneOverflow) ) {
+            std::cout << "Invalid policy after --scene-overflow (reject, drop-oldest, coalesce): "
+                      << policyParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --snapshot-file <path> : persistent output snapshot location. Empty
+    // means the per-port default under SNAPSHOT_FILE_DEFAULT_DIR, resolved
+    // once the port is known. --no-snapshot disables it.
+    std::string snapshotFile;
+    bool snapshotEnabled = !argParser->optionExists("--no-snapshot");
+    if ( argParser->optionExists("--snapshot-file") ) {
+        snapshotFile = argParser->getParam("--snapshot-file");
+        if ( snapshotFile.empty() ) {
+            std::cout << "Missing path after --snapshot-file" << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --patch-file <path> : logical-to-physical patch table
+    std::string patchFile;
+    if ( argParser->optionExists("--patch-file") ) {
+        patchFile = argParser->getParam("--patch-file");
+        if ( patchFile.empty() ) {
+            std::cout << "Missing path after --patch-file" << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --trace-file <path> : show trace (OSC packets, ticks, frames) location.
+    // Empty means the per-port default under TRACE_FILE_DEFAULT_DIR.
+    // --trace-mb <n> : ring size per writer thread. --no-trace disables it.
+    std::string traceFile;
+    bool traceEnabled = !argParser->optionExists("--no-trace");
+    int traceMb = CuemsConstants::TRACE_REGION_MB_DEFAULT;
+    if ( argParser->optionExists("--trace-file") ) {
+        traceFile = argParser->getParam("--trace-file");
+        if ( traceFile.empty() ) {
+            std::cout << "Missing path after --trace-file" << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+    if ( argParser->optionExists("--trace-mb") ) {
+        std::string mbParam = argParser->getParam("--trace-mb");
+        try {
+            traceMb = std::stoi(mbParam);
+        } catch ( const std::exception& e ) {
+            traceMb = 0;
+        }
+        if ( traceMb < 1 || traceMb > CuemsConstants::TRACE_REGION_MB_MAX ) {
+            std::cout << "Invalid size after --trace-mb (1-"
+                      << CuemsConstants::TRACE_REGION_MB_MAX << "): " << mbParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --replay : virtual clock for tools/dmxreplay; render ticks only run on
+    // /replay_tick. Neither the trace nor the snapshot of a real run is
+    // touched.
+    bool replay = argParser->optionExists("--replay");
+    if ( replay ) {
+        traceEnabled = false;
+        snapshotEnabled = false;
+    }
+
+    // --null-output : discard DMX instead of sending it to olad, which is
+    // then not required at all (load tests, benchmarks).
+    bool nullOutput = argParser->optionExists("--null-output");
+
+    // --osc-single : read OSC through oscpack's one-datagram-per-recv socket
+    // instead of the batched recvmmsg() receiver.
+    // --osc-rcvbuf <bytes> : batched receiver socket buffer (0 = system default).
+    bool batchedOsc = !argParser->optionExists("--osc-single");
+    int oscRcvBufBytes = CuemsConstants::OSC_RCVBUF_DEFAULT;
+    if ( argParser->optionExists("--osc-rcvbuf") ) {
+        std::string rcvBufParam = argParser->getParam("--osc-rcvbuf");
+        try {
+            oscRcvBufBytes = std::stoi(rcvBufParam);
+        } catch ( const std::exception& e ) {
+            std::cout << "Invalid integer after --osc-rcvbuf: "
+                      << rcvBufParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
+    // --rt-priority <1-99> : run the render thread under SCHED_FIFO at this
+    // priority, with memory locked and pre-faulted.
+    // --rt-cpu <n> : pin the render thread to CPU n.
+    int rtPriority = 0;
+    int rtCpu = -1;
+    if ( argParser->optionExists("--rt-priority") ) {
+        std::string prioParam = argParser->getParam("--rt-priority");
+        try {
+            rtPriority = std::stoi(prioParam);
+        } catch ( const std::exception& e ) {
+            rtPriority = -1;
+        }
+        if ( rtPriority < CuemsConstants::RT_PRIORITY_MIN || rtPriority > CuemsConstants::RT_PRIORITY_MAX ) {
+            std::cout << "Invalid priority after --rt-priority (1-99): "
+                      << prioParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+    if ( argParser->optionExists("--rt-cpu") ) {
+        std::string cpuParam = argParser->getParam("--rt-cpu");
+        try {
+            rtCpu = std::stoi(cpuParam);
+        } catch ( const std::exception& e ) {
+            rtCpu = -1;
+        }
+        if ( rtCpu < 0 || rtCpu >= CPU_SETSIZE ) {
+            std::cout << "Invalid CPU number after --rt-cpu: "
+                      << cpuParam << endl;
+            logger->getLogger()->logError(
+                "Exiting with result code: "
+                + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+            exit(CUEMS_EXIT_WRONG_PARAMETERS);
+        }
+    }
+
     delete argParser;
 
     // End of command line parsing
@@ -205,125 +417,103 @@ int main( int argc, char *argv[] ) {
     }
     else {
         // Cold-boot resilience: the engine spawns us as soon as the node boots,
-        // but olad's RPC may not be accepting connections yet. Constructing
-        // DmxPlayer in that window makes its OLA probe throw, and the unwinding
-        // could wedge the player with no DMX output. Wait here for olad to
-        // become reachable BEFORE constructing — so DmxPlayer is built exactly
-        // once, after OLA is ready (no repeated construction, no leaked member
-        // threads). Bounded by a generous deadline because the engine does NOT
-        // respawn a dead player; on timeout we exit fatally so it is visible.
+        // possibly before olad accepts RPC connections and before the ALSA
+        // sequencer has enumerated Midi Through. Both must be ready BEFORE
+        // DmxPlayer is constructed (see waitForOlad() / waitForMidiThrough()
+        // for why), but they are independent, so both gates run concurrently
+        // and cold-boot delay is the slower of the two rather than their sum.
+        // Bounded by generous deadlines because the engine does NOT respawn a
+        // dead player; on timeout we exit fatally so it is visible.
         {
             int olaWaitS = 180;
             if ( const char* env = std::getenv("CUEMS_DMX_OLA_WAIT_S") ) {
                 try { olaWaitS = std::max( 0, std::stoi(env) ); }
                 catch ( const std::exception& ) { /* keep default */ }
             }
-            ola::InitLogging( ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR );
-            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( olaWaitS );
-            int attempt = 0;
-            bool olaReady = false;
-            while ( !olaReady ) {
-                try {
-                    // auto_start=false: only succeed against an already-running
-                    // olad. With the default (true), this probe would itself
-                    // fork a rogue `olad --daemon` as the cuems user (no plugdev,
-                    // read-only /etc/ola) which squats :9010 and cannot drive USB
-                    // DMX widgets — defeating the purpose of waiting for the real
-                    // (systemd) olad. Wait for the real one instead.
-                    ola::client::OlaClientWrapper probe(false);
-                    olaReady = probe.Setup();
-                }
-                catch ( const std::exception& ) { olaReady = false; }
-                if ( olaReady ) break;
-                if ( std::chrono::steady_clock::now() >= deadline ) {
-                    logger->logError( "olad (OLA RPC) not reachable after "
-                        + std::to_string(olaWaitS) + "s — exiting" );
-                    delete logger;
-                    exit( CUEMS_EXIT_FAILED_OLA_SETUP );
-                }
-                ++attempt;
-                int delayMs = std::min( 500 * std::min(attempt, 10), 5000 );
-                logger->logInfo( "Waiting for olad to become reachable (attempt "
-                    + std::to_string(attempt) + ")" );
-                std::this_thread::sleep_for( std::chrono::milliseconds(delayMs) );
-            }
-        }
-
-        // Cold-boot resilience (MIDI) — sibling of the OLA gate above, runs
-        // after it (independent; order irrelevant). The engine spawns us seconds
-        // after boot, possibly before the ALSA sequencer is up or before Midi
-        // Through Port-0 is enumerated. DmxPlayer's mtcReceiver member is built
-        // AFTER the OscReceiver base; if its construction throws — either the
-        // RtMidiIn base ctor (ALSA seq not ready) or the getPortCount()==0 guard
-        // — the throw unwinds through the already-built OscReceiver base and
-        // DEADLOCKS in ~OscReceiver (lost AsynchronousBreak before join) -> main()
-        // hangs forever in `new DmxPlayer`, leaving a player with an OSC socket but
-        // no MTC and no DMX. Gate here until a usable MIDI source exists: a
-        // successful RtMidiIn probe (proves ALSA seq is up) AND a port whose name
-        // STARTS WITH "Midi Through" (the real kernel dummy is client 14 -> index 0,
-        // exactly the portIndex MtcReceiver opens; starts-with excludes the rtpmidid
-        // mirror ports "rtpmidid:Midi Through-..."). Then the mtcReceiver ctor runs
-        // in a verified-good state and cannot throw. On timeout exit fatally (the
-        // engine does not respawn a dead player, so failing loud beats a zombie).
-        {
             int midiWaitS = 180;
             if ( const char* env = std::getenv("CUEMS_DMX_MIDI_WAIT_S") ) {
                 try { midiWaitS = std::max( 0, std::stoi(env) ); }
                 catch ( const std::exception& ) { /* keep default */ }
             }
-            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( midiWaitS );
-            int attempt = 0;
-            bool midiReady = false;
-            // One probe reused across iterations (getPortCount/getPortName re-query
-            // the ALSA seq live) so we don't churn an ALSA client every 0.5 s. Built
-            // lazily because the RtMidiIn ctor itself throws while ALSA seq isn't up.
-            std::unique_ptr<RtMidiIn> probe;
-            while ( !midiReady ) {
-                try {
-                    if ( !probe )
-                        probe.reset( new RtMidiIn( MTCRECV_DEFAULT_API, "cuems-dmxplayer-midiprobe" ) );
-                    // Require port 0 (the index MtcReceiver opens) to be the real
-                    // Midi Through, and TEST-OPEN it — the exact subscription
-                    // MtcReceiver performs. At cold boot the port can EXIST but not
-                    // yet be connectable ("ALSA error making port connection"), and
-                    // openPort throws then; retry until the subscription succeeds so
-                    // MtcReceiver's openPort(0) a moment later cannot throw/unwind.
-                    if ( probe->getPortCount() > 0
-                         && probe->getPortName(0).rfind("Midi Through", 0) == 0 ) {
-                        probe->openPort( 0, "cuems-dmxplayer-midiprobe" );
-                        if ( probe->isPortOpen() ) {
-                            probe->closePort();
-                            midiReady = true;
-                        }
-                    }
-                }
-                catch ( const std::exception& ) {   // RtMidiError : std::exception
-                    midiReady = false;
-                    probe.reset();                   // drop a half-open client; rebuild next loop
-                }
-                if ( midiReady ) break;
-                if ( std::chrono::steady_clock::now() >= deadline ) {
-                    logger->logError( "No 'Midi Through' MIDI input port after "
-                        + std::to_string(midiWaitS) + "s — exiting" );
-                    probe.reset();
-                    delete logger;
-                    exit( CUEMS_EXIT_NO_MIDI_PORTS_FOUND );
-                }
-                ++attempt;
-                int delayMs = std::min( 500 * std::min(attempt, 10), 5000 );
-                logger->logInfo( "Waiting for 'Midi Through' MIDI input port (attempt "
-                    + std::to_string(attempt) + ")" );
-                std::this_thread::sleep_for( std::chrono::milliseconds(delayMs) );
+            ola::InitLogging( ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR );
+
+            // A gate that times out aborts the other one, so we exit promptly
+            // and never tear down the logger under a still-running gate. The
+            // first gate to fail records its exit code before aborting; the
+            // aborted gate then also returns false but must not be blamed.
+            std::atomic<bool> abortGates{ false };
+            std::atomic<int> failedGate{ 0 };
+            auto failGate = [&]( int exitCode ) {
+                int none = 0;
+                failedGate.compare_exchange_strong( none, exitCode );
+                abortGates = true;
+            };
+            auto olaGate = std::async( std::launch::async, [&]() {
+                bool ready = nullOutput || waitForOlad( olaWaitS, abortGates );
+                if ( !ready ) failGate( CUEMS_EXIT_FAILED_OLA_SETUP );
+                return ready;
+            } );
+            auto midiGate = std::async( std::launch::async, [&]() {
+                bool ready = waitForMidiThrough( midiWaitS, abortGates );
+                if ( !ready ) failGate( CUEMS_EXIT_NO_MIDI_PORTS_FOUND );
+                return ready;
+            } );
+            olaGate.get();
+            midiGate.get();
+
+            if ( 0 != failedGate ) {
+                delete logger;
+                exit( failedGate );
             }
-            // probe destroyed here, before constructing DmxPlayer.
+            logger->logInfo( "Startup: readiness gates passed at +"
+                + std::to_string( msSince(startupTime) ) + " ms" );
         }
 
         // olad is reachable — construct exactly once.
         try {
-            myDmxPlayer = new DmxPlayer( portNumber, "", stopOnLostFlag, followMTCFlag, "DMX_Player-" + processUuid );
+            myDmxPlayer = new DmxPlayer( portNumber, "", stopOnLostFlag, followMTCFlag, "DMX_Player-" + processUuid,
+                                         batchedOsc, oscRcvBufBytes );
+            if ( !myDmxPlayer->isOscListening() ) {
+                delete logger;
+                exit( CUEMS_EXIT_INIT_FAILED );
+            }
+            myDmxPlayer->setStartupTime( startupTime );
+            myDmxPlayer->setNullOutput( nullOutput );
+            myDmxPlayer->setRealtime( rtPriority, rtCpu );
+            myDmxPlayer->setReplay( replay );
+            logger->logInfo( "Startup: player constructed at +"
+                + std::to_string( msSince(startupTime) ) + " ms" );
             if (outputLatencyMs >= 0) {
                 myDmxPlayer->setOutputLatencyMs(outputLatencyMs);
             }
+            if (maxFps >= 0) {
+                myDmxPlayer->setOutputFpsCap(maxFps);
+            }
+            myDmxPlayer->setSceneQueueLimits(static_cast<size_t>(maxScenes),
+                static_cast<size_t>(maxSceneMb) * 1024 * 1024, sceneOverflow);
+            if (snapshotEnabled) {
+                if (snapshotFile.empty()) {
+                    snapshotFile = std::string(CuemsConstants::SNAPSHOT_FILE_DEFAULT_DIR)
+                        + "/cuems-dmxplayer-" + std::to_string(portNumber) + ".snapshot";
+                }
+                myDmxPlayer->setSnapshotFile(snapshotFile);
+            }
+            // A show must not start unpatched
+            if (!patchFile.empty() && !myDmxPlayer->setPatchFile(patchFile)) {
+                std::cout << "Cannot load the patch file " << patchFile << endl;
+                logger->logError(
+                    "Exiting with result code: "
+                    + std::to_string(CUEMS_EXIT_WRONG_PARAMETERS));
+                delete logger;
+                exit(CUEMS_EXIT_WRONG_PARAMETERS);
+            }
+            if (traceEnabled) {
+                if (traceFile.empty()) {
+                    traceFile = std::string(CuemsConstants::TRACE_FILE_DEFAULT_DIR)
+                        + "/cuems-dmxplayer-" + std::to_string(portNumber) + ".trace";
+                }
+                myDmxPlayer->setTraceFile(traceFile, static_cast<size_t>(traceMb) * 1024 * 1024);
+            }
         }
         catch ( const std::exception& e ) {
             logger->logError( "Failed to create DmxPlayer: " + std::string(e.what()) );
@@ -353,6 +543,194 @@ int main( int argc, char *argv[] ) {
 
 }
 
+//////////////////////////////////////////////////////////
+long msSince( std::chrono::steady_clock::time_point since ) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - since ).count();
+}
+
+//////////////////////////////////////////////////////////
+// Cheap olad readiness signal: a plain localhost connect to the RPC port
+// fails instantly while olad is down, so it can be polled at a short fixed
+// interval without the cost of building an OlaClientWrapper every time.
+static bool olaRpcPortAccepting( void ) {
+    int fd = socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if ( fd < 0 ) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons( CuemsConstants::OLA_RPC_PORT );
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    bool accepting = ( 0 == connect( fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr) ) );
+    close( fd );
+    return accepting;
+}
+
+//////////////////////////////////////////////////////////
+// Wait for olad to accept RPC connections. Constructing DmxPlayer while olad
+// is down would make its OLA setup fail and the unwinding could wedge the
+// player with no DMX output; waiting here means DmxPlayer is built exactly
+// once, after OLA is ready (no repeated construction, no leaked member
+// threads). The RPC port is watched at STARTUP_GATE_POLL_MS; only once it
+// accepts do we run the full client probe, so readiness is noticed within
+// one poll instead of after a back-off sleep.
+bool waitForOlad( int waitS, const std::atomic<bool> &abortWait ) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::seconds( waitS );
+    auto nextLog = start + std::chrono::seconds( CuemsConstants::STARTUP_GATE_LOG_INTERVAL_S );
+    int probes = 0;
+
+    while ( !abortWait ) {
+        if ( olaRpcPortAccepting() ) {
+            ++probes;
+            bool olaReady = false;
+            try {
+                // auto_start=false: only succeed against an already-running
+                // olad. With the default (true), this probe would itself
+                // fork a rogue `olad --daemon` as the cuems user (no plugdev,
+                // read-only /etc/ola) which squats :9010 and cannot drive USB
+                // DMX widgets — defeating the purpose of waiting for the real
+                // (systemd) olad. Wait for the real one instead.
+                ola::client::OlaClientWrapper probe(false);
+                olaReady = probe.Setup();
+            }
+            catch ( const std::exception& ) { olaReady = false; }
+            if ( olaReady ) {
+                logger->logInfo( "Startup: olad reachable after "
+                    + std::to_string( msSince(start) ) + " ms ("
+                    + std::to_string( probes ) + " client probes)" );
+                return true;
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        if ( now >= deadline ) {
+            logger->logError( "olad (OLA RPC) not reachable after "
+                + std::to_string(waitS) + "s — exiting" );
+            return false;
+        }
+        if ( now >= nextLog ) {
+            logger->logInfo( "Waiting for olad to become reachable ("
+                + std::to_string( msSince(start) / 1000 ) + " s)" );
+            nextLog += std::chrono::seconds( CuemsConstants::STARTUP_GATE_LOG_INTERVAL_S );
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( CuemsConstants::STARTUP_GATE_POLL_MS ) );
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////
+// ALSA sequencer client subscribed to the system announce port: client and
+// port start/exit events wake the MIDI gate as soon as Midi Through shows up.
+// Returns nullptr while the sequencer itself is not up yet.
+static snd_seq_t* openSeqAnnounceWatch( void ) {
+    snd_seq_t *seq = nullptr;
+    if ( snd_seq_open( &seq, "default", SND_SEQ_OPEN_INPUT, SND_SEQ_NONBLOCK ) < 0 )
+        return nullptr;
+    snd_seq_set_client_name( seq, "cuems-dmxplayer-midiwatch" );
+    int port = snd_seq_create_simple_port( seq, "announce",
+        SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_NO_EXPORT,
+        SND_SEQ_PORT_TYPE_APPLICATION );
+    if ( port < 0
+         || snd_seq_connect_from( seq, port, SND_SEQ_CLIENT_SYSTEM, SND_SEQ_PORT_SYSTEM_ANNOUNCE ) < 0 ) {
+        snd_seq_close( seq );
+        return nullptr;
+    }
+    return seq;
+}
+
+//////////////////////////////////////////////////////////
+// Block until an announce event arrives or timeoutMs elapses, then drain
+// the queued events. Without a watch this is a plain sleep.
+static void waitSeqAnnounce( snd_seq_t *seq, int timeoutMs ) {
+    if ( seq == nullptr ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( timeoutMs ) );
+        return;
+    }
+    int count = snd_seq_poll_descriptors_count( seq, POLLIN );
+    std::vector<pollfd> fds( std::max( count, 1 ) );
+    count = snd_seq_poll_descriptors( seq, fds.data(), fds.size(), POLLIN );
+    if ( poll( fds.data(), count, timeoutMs ) > 0 ) {
+        snd_seq_event_t *ev = nullptr;
+        while ( snd_seq_event_input( seq, &ev ) >= 0 ) { /* drain */ }
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Wait for a usable MIDI source. DmxPlayer's mtcReceiver member is built
+// AFTER the OscReceiver base; if its construction throws — either the
+// RtMidiIn base ctor (ALSA seq not ready) or the getPortCount()==0 guard
+// — the throw unwinds through the already-built OscReceiver base and
+// DEADLOCKS in ~OscReceiver (lost AsynchronousBreak before join) -> main()
+// hangs forever in `new DmxPlayer`, leaving a player with an OSC socket but
+// no MTC and no DMX. Gate here until a successful RtMidiIn probe (proves
+// ALSA seq is up) AND a port whose name STARTS WITH "Midi Through" (the real
+// kernel dummy is client 14 -> index 0, exactly the portIndex MtcReceiver
+// opens; starts-with excludes the rtpmidid mirror ports
+// "rtpmidid:Midi Through-..."). Then the mtcReceiver ctor runs in a
+// verified-good state and cannot throw. Re-probes are driven by ALSA
+// announce events, with a short timeout as fallback.
+bool waitForMidiThrough( int waitS, const std::atomic<bool> &abortWait ) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::seconds( waitS );
+    auto nextLog = start + std::chrono::seconds( CuemsConstants::STARTUP_GATE_LOG_INTERVAL_S );
+    bool midiReady = false;
+    // One probe reused across iterations (getPortCount/getPortName re-query
+    // the ALSA seq live) so we don't churn an ALSA client on every wake-up.
+    // Built lazily because the RtMidiIn ctor itself throws while ALSA seq isn't up.
+    std::unique_ptr<RtMidiIn> probe;
+    snd_seq_t *watch = nullptr;
+
+    while ( !abortWait ) {
+        try {
+            if ( !probe )
+                probe.reset( new RtMidiIn( MTCRECV_DEFAULT_API, "cuems-dmxplayer-midiprobe" ) );
+            // Require port 0 (the index MtcReceiver opens) to be the real
+            // Midi Through, and TEST-OPEN it — the exact subscription
+            // MtcReceiver performs. At cold boot the port can EXIST but not
+            // yet be connectable ("ALSA error making port connection"), and
+            // openPort throws then; retry until the subscription succeeds so
+            // MtcReceiver's openPort(0) a moment later cannot throw/unwind.
+            if ( probe->getPortCount() > 0
+                 && probe->getPortName(0).rfind("Midi Through", 0) == 0 ) {
+                probe->openPort( 0, "cuems-dmxplayer-midiprobe" );
+                if ( probe->isPortOpen() ) {
+                    probe->closePort();
+                    midiReady = true;
+                }
+            }
+        }
+        catch ( const std::exception& ) {   // RtMidiError : std::exception
+            midiReady = false;
+            probe.reset();                   // drop a half-open client; rebuild next loop
+        }
+        if ( midiReady ) {
+            logger->logInfo( "Startup: 'Midi Through' ready after "
+                + std::to_string( msSince(start) ) + " ms" );
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if ( now >= deadline ) {
+            logger->logError( "No 'Midi Through' MIDI input port after "
+                + std::to_string(waitS) + "s — exiting" );
+            break;
+        }
+        if ( now >= nextLog ) {
+            logger->logInfo( "Waiting for 'Midi Through' MIDI input port ("
+                + std::to_string( msSince(start) / 1000 ) + " s)" );
+            nextLog += std::chrono::seconds( CuemsConstants::STARTUP_GATE_LOG_INTERVAL_S );
+        }
+        // A port that exists but is not connectable yet raises no further
+        // announce event, hence the timeout.
+        if ( watch == nullptr )
+            watch = openSeqAnnounceWatch();
+        waitSeqAnnounce( watch, CuemsConstants::STARTUP_GATE_MIDI_TIMEOUT_MS );
+    }
+
+    if ( watch != nullptr )
+        snd_seq_close( watch );
+    // probe destroyed here, before DmxPlayer is constructed.
+    return midiReady;
+}
+
 //////////////////////////////////////////////////////////
 void showcopyright( void ) {
     std::cout << "DmxPlayer - Copyright (C) 2020 Stage Lab & bTactic" << endl <<
@@ -374,6 +752,27 @@ void showusage( void ) {
         "               it is indicated to the player through OSC." << endl << endl <<
         "           --uuid , -u <uuid_string> : indicates a unique identifier for the dmxplayer to be" << endl <<
         "               recognized in different internal identification porpouses such as OLA environment." << endl << endl <<
+        "           --max-fps <fps> : caps the DMX frames/s sent per universe (default 44, 0 = uncapped)." << endl << endl <<
+        "           --max-scenes <n> : scenes queued at most (default 4096, 0 = no limit)." << endl <<
+        "           --max-scene-mb <n> : MiB queued scenes may hold (default 64, 0 = no limit)." << endl <<
+        "           --scene-overflow <policy> : reject (default), drop-oldest or coalesce a scene past" << endl <<
+        "               either cap; the sender gets a /scene_queue reply." << endl << endl <<
+        "           --snapshot-file <path> : output snapshot restored after a restart" << endl <<
+        "               (default /dev/shm/cuems-dmxplayer-<port>.snapshot)." << endl <<
+        "           --no-snapshot : do not keep or restore the output snapshot." << endl << endl <<
+        "           --patch-file <path> : logical-to-physical patch table; cues address logical channels." << endl << endl <<
+        "           --trace-file <path> : show trace of OSC input, ticks and frames; the previous one is kept" << endl <<
+        "               as <path>.prev (default /dev/shm/cuems-dmxplayer-<port>.trace)." << endl <<
+        "           --trace-mb <n> : trace ring size per thread in MiB (default 32)." << endl <<
+        "           --no-trace : do not record the show trace." << endl <<
+        "           --replay : virtual clock for tools/dmxreplay: ticks only run on /replay_tick; no trace" << endl <<
+        "               or snapshot." << endl << endl <<
+        "           --null-output : discard DMX output; olad is not needed (load tests)." << endl << endl <<
+        "           --osc-rcvbuf <bytes> : OSC socket receive buffer (default 4 MiB, 0 = system default)." << endl <<
+        "           --osc-single : read OSC one datagram per syscall (oscpack socket) instead of in batches." << endl << endl <<
+        "           --rt-priority <1-99> : run the render thread under SCHED_FIFO at this priority, with" << endl <<
+        "               memory locked (needs CAP_SYS_NICE / CAP_IPC_LOCK or matching rtprio/memlock limits)." << endl <<
+        "           --rt-cpu <n> : pin the render thread to CPU n." << endl << endl <<
         "           OTHER OPTIONS:" << endl <<
         "           --show : shows license disclaimers." << endl <<
         "               w : shows warranty disclaimer." << endl <<
@@ -31,6 +31,8 @@
 #include <string>
 #include <filesystem>
 #include <csignal>
+#include <atomic>
+#include <chrono>
 #include "commandlineparser.h"
 #include "dmxplayer.h"
 #include "cuems_errors.h"
@@ -44,6 +46,12 @@ void showusage ( void );
 void showwarrantydisclaimer( void );
 void showcopydisclaimer( void );
 
+// Startup readiness gates, run concurrently before DmxPlayer is built.
+// Each returns false on timeout or when abortWait is raised.
+bool waitForOlad( int waitS, const std::atomic<bool> &abortWait );
+bool waitForMidiThrough( int waitS, const std::atomic<bool> &abortWait );
+long msSince( std::chrono::steady_clock::time_point since );
+
 // System signal handlers
 void sigTermHandler( int signum );
 void sigIntHandler( int signum );
@@ -0,0 +1,211 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems batched OSC UDP receiver code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "oscbatchreceiver.h"
+#include "cuems_constants.h"
+#include "./cuemslogger/cuemslogger.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <oscpack/ip/IpEndpointName.h>
+
+namespace {
+
+// Room for one SO_RXQ_OVFL control message per datagram
+constexpr size_t CONTROL_SIZE = CMSG_SPACE(sizeof(uint32_t));
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+OscBatchReceiver::OscBatchReceiver(int port, int rcvBufBytes, PacketListener *listener)
+    : m_listener(listener)
+{
+    m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("OSC socket: ") + std::strerror(errno));
+    }
+
+    int one = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (0 != setsockopt(m_fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one))) {
+        CuemsLogger::getLogger()->logWarning("OSC: kernel drop counter (SO_RXQ_OVFL) unavailable");
+    }
+
+    // SO_RCVBUFFORCE passes net.core.rmem_max when we have CAP_NET_ADMIN;
+    // otherwise the request is capped there
+    if (0 < rcvBufBytes
+        && 0 != setsockopt(m_fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvBufBytes, sizeof(rcvBufBytes))) {
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvBufBytes, sizeof(rcvBufBytes));
+    }
+    socklen_t len = sizeof(m_rcvBufBytes);
+    getsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &m_rcvBufBytes, &len);
+    if (0 < rcvBufBytes && m_rcvBufBytes < rcvBufBytes) {
+        CuemsLogger::getLogger()->logWarning("OSC: receive buffer capped at "
+            + std::to_string(m_rcvBufBytes) + " bytes (raise net.core.rmem_max)");
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (0 != bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+        int err = errno;
+        close(m_fd);
+        throw std::runtime_error("OSC bind to port " + std::to_string(port) + ": " + std::strerror(err));
+    }
+
+    m_stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stopFd < 0) {
+        int err = errno;
+        close(m_fd);
+        throw std::runtime_error(std::string("OSC eventfd: ") + std::strerror(err));
+    }
+
+    // Fixed receive slots, wired once: recvmmsg() only fills them in
+    const size_t n = CuemsConstants::OSC_BATCH_SIZE;
+    m_buffers.resize(n * CuemsConstants::OSC_MAX_DATAGRAM);
+    m_msgs.resize(n);
+    m_iovs.resize(n);
+    m_addrs.resize(n);
+    m_controls.resize(n * CONTROL_SIZE);
+
+    m_thread = std::thread(&OscBatchReceiver::run, this);
+    CuemsLogger::getLogger()->logInfo("OSC: batched receiver on port " + std::to_string(port)
+        + ", receive buffer " + std::to_string(m_rcvBufBytes) + " bytes");
+}
+
+//////////////////////////////////////////////////////////
+OscBatchReceiver::~OscBatchReceiver()
+{
+    uint64_t one = 1;
+    if (sizeof(one) != write(m_stopFd, &one, sizeof(one))) {
+        shutdown(m_fd, SHUT_RDWR);
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close(m_stopFd);
+    close(m_fd);
+}
+
+//////////////////////////////////////////////////////////
+OscBatchReceiver::Metrics OscBatchReceiver::metrics() const
+{
+    Metrics m;
+    m.datagrams = m_datagrams.load(std::memory_order_relaxed);
+    m.batches = m_batches.load(std::memory_order_relaxed);
+    m.truncated = m_truncated.load(std::memory_order_relaxed);
+    m.kernelDrops = m_kernelDrops.load(std::memory_order_relaxed);
+    m.rcvBufBytes = m_rcvBufBytes;
+    return m;
+}
+
+//////////////////////////////////////////////////////////
+void OscBatchReceiver::run()
+{
+    const unsigned int n = CuemsConstants::OSC_BATCH_SIZE;
+    pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_stopFd, POLLIN, 0}};
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (EINTR == errno) continue;
+            CuemsLogger::getLogger()->logError(std::string("OSC poll: ") + std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+
+        // Drain everything queued, a batch per syscall
+        while (true) {
+            for (unsigned int i = 0; i < n; ++i) {
+                m_iovs[i].iov_base = &m_buffers[i * CuemsConstants::OSC_MAX_DATAGRAM];
+                m_iovs[i].iov_len = CuemsConstants::OSC_MAX_DATAGRAM;
+                msghdr &h = m_msgs[i].msg_hdr;
+                h.msg_name = &m_addrs[i];
+                h.msg_namelen = sizeof(sockaddr_storage);
+                h.msg_iov = &m_iovs[i];
+                h.msg_iovlen = 1;
+                h.msg_control = &m_controls[i * CONTROL_SIZE];
+                h.msg_controllen = CONTROL_SIZE;
+                h.msg_flags = 0;
+            }
+            int got = recvmmsg(m_fd, m_msgs.data(), n, MSG_DONTWAIT, nullptr);
+            if (got <= 0) {
+                if (got < 0 && EINTR == errno) continue;
+                break;              // EAGAIN: socket drained, back to poll()
+            }
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            dispatch(got);
+            if (got < static_cast<int>(n)) {
+                break;
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+void OscBatchReceiver::dispatch(unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i) {
+        const msghdr &h = m_msgs[i].msg_hdr;
+
+        // The drop counter is cumulative for the socket: keep the latest
+        for (cmsghdr *c = CMSG_FIRSTHDR(&h); c != nullptr; c = CMSG_NXTHDR(const_cast<msghdr *>(&h), c)) {
+            if (SOL_SOCKET == c->cmsg_level && SO_RXQ_OVFL == c->cmsg_type) {
+                uint32_t drops = 0;
+                std::memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                m_kernelDrops.store(drops, std::memory_order_relaxed);
+            }
+        }
+
+        if (h.msg_flags & MSG_TRUNC) {
+            m_truncated.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const sockaddr_in *from = reinterpret_cast<const sockaddr_in *>(&m_addrs[i]);
+        IpEndpointName remote(ntohl(from->sin_addr.s_addr), ntohs(from->sin_port));
+        m_datagrams.fetch_add(1, std::memory_order_relaxed);
+        try {
+            m_listener->ProcessPacket(static_cast<const char *>(m_iovs[i].iov_base),
+                                      static_cast<int>(m_msgs[i].msg_len), remote);
+        } catch (const std::exception &e) {
+            // Malformed packet: drop it, keep the listener alive
+            CuemsLogger::getLogger()->logWarning(std::string("OSC: bad packet: ") + e.what());
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems batched OSC UDP receiver header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef OSCBATCHRECEIVER_H
+#define OSCBATCHRECEIVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <oscpack/ip/PacketListener.h>
+
+//////////////////////////////////////////////////////////
+// UDP listener thread that drains the socket with recvmmsg(): every wake-up
+// reads up to OSC_BATCH_SIZE datagrams in one syscall and hands them to the
+// PacketListener one after another, in arrival order. The receive buffer
+// can be enlarged to absorb cue bursts, and the kernel's count of datagrams
+// dropped on a full buffer (SO_RXQ_OVFL) is tracked.
+//
+// oscpack's UdpListeningReceiveSocket (inside OscReceiver) reads a single
+// datagram per recv() and offers no access to its socket options.
+class OscBatchReceiver
+{
+    public:
+        struct Metrics
+        {
+            uint64_t datagrams = 0;
+            uint64_t batches = 0;       // recvmmsg() calls that returned data
+            uint64_t truncated = 0;     // Datagrams larger than the slot, discarded
+            uint64_t kernelDrops = 0;   // Dropped by the kernel, as stamped on the latest datagram
+            int rcvBufBytes = 0;        // Effective SO_RCVBUF
+        };
+
+        // Binds port on all interfaces and starts the listener thread.
+        // rcvBufBytes <= 0 keeps the system default. Throws
+        // std::runtime_error if the socket cannot be set up.
+        OscBatchReceiver(int port, int rcvBufBytes, PacketListener *listener);
+        ~OscBatchReceiver();
+        OscBatchReceiver(const OscBatchReceiver &) = delete;
+        OscBatchReceiver &operator=(const OscBatchReceiver &) = delete;
+
+        Metrics metrics() const;
+
+    private:
+        void run();
+        void dispatch(unsigned int count);
+
+        int m_fd = -1;
+        int m_stopFd = -1;                  // eventfd, wakes the thread to exit
+        PacketListener *m_listener;
+
+        std::vector<char> m_buffers;        // OSC_BATCH_SIZE slots of OSC_MAX_DATAGRAM
+        std::vector<mmsghdr> m_msgs;
+        std::vector<iovec> m_iovs;
+        std::vector<sockaddr_storage> m_addrs;
+        std::vector<char> m_controls;       // SO_RXQ_OVFL cmsg per slot
+
+        std::atomic<uint64_t> m_datagrams{0};
+        std::atomic<uint64_t> m_batches{0};
+        std::atomic<uint64_t> m_truncated{0};
+        std::atomic<uint64_t> m_kernelDrops{0};
+        int m_rcvBufBytes = 0;
+
+        std::thread m_thread;
+};
+
+#endif // OSCBATCHRECEIVER_H
@@ -0,0 +1,183 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems output masters code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "outputmasters.h"
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////
+uint16_t OutputMasters::fromFloat(float level)
+{
+    if (!(level > 0.0f)) {
+        return 0;
+    }
+    return static_cast<uint16_t>(std::lround(std::min(level, 1.0f) * FULL));
+}
+
+//////////////////////////////////////////////////////////
+// A fade starts from wherever the master is now, so a new level given
+// while fading takes over smoothly
+void OutputMasters::setLevel(unsigned int master, uint16_t level, int64_t fadeUs, int64_t nowUs)
+{
+    Master &m = m_masters[master];
+    level = std::min(level, FULL);
+    if (0 < fadeUs && level != m.level) {
+        m.level0 = m.level;
+        m.level1 = level;
+        m.us0 = nowUs;
+        m.us1 = nowUs + fadeUs;
+        m_fading |= uint64_t(1) << master;
+        return;
+    }
+    m_fading &= ~(uint64_t(1) << master);
+    if (level != m.level) {
+        m.level = level;
+        ++m_version;
+    }
+}
+
+//////////////////////////////////////////////////////////
+void OutputMasters::assign(unsigned int sub, uint32_t universe, unsigned int first, unsigned int count, bool on)
+{
+    UniverseMasters *univ = find(universe);
+    if (univ == nullptr) {
+        if (!on) {
+            return;
+        }
+        univ = &m_universes[universe];
+    }
+    auto &channels = univ->channels[sub - 1];
+    for (unsigned int ch = first; ch < first + count; ++ch) {
+        channels.set(ch, on);
+    }
+    if (channels.any()) {
+        univ->subs |= uint32_t(1) << (sub - 1);
+    }
+    else {
+        univ->subs &= ~(uint32_t(1) << (sub - 1));
+    }
+    univ->version = 0;
+}
+
+//////////////////////////////////////////////////////////
+bool OutputMasters::update(int64_t nowUs)
+{
+    if (0 == m_fading) {
+        return false;
+    }
+    for (unsigned int i = 0; i < COUNT; ++i) {
+        if (0 == (m_fading & (uint64_t(1) << i))) {
+            continue;
+        }
+        Master &m = m_masters[i];
+        uint16_t level = m.level1;
+        if (nowUs < m.us1) {
+            int64_t span = m.us1 - m.us0;
+            int64_t done = std::max<int64_t>(0, nowUs - m.us0);
+            level = static_cast<uint16_t>(m.level0 + (int64_t(m.level1) - m.level0) * done / span);
+        }
+        else {
+            m_fading &= ~(uint64_t(1) << i);
+        }
+        m.level = level;
+    }
+    ++m_version;
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+bool OutputMasters::isFull(uint32_t universe)
+{
+    if (FULL != m_masters[0].level) {
+        return false;
+    }
+    UniverseMasters *univ = find(universe);
+    if (univ == nullptr) {
+        return true;
+    }
+    if (univ->version != m_version) {
+        rebuild(*univ);
+    }
+    return univ->full;
+}
+
+//////////////////////////////////////////////////////////
+// The multiply loops are branch-free so the compiler vectorizes them
+void OutputMasters::apply(uint32_t universe, const uint8_t *in, uint8_t *out, size_t size)
+{
+    size = std::min<size_t>(size, CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+    constexpr uint32_t round = 1u << (SHIFT - 1);
+    UniverseMasters *univ = find(universe);
+    if (univ != nullptr && univ->version != m_version) {
+        rebuild(*univ);
+    }
+
+    if (univ == nullptr || 0 == univ->subs) {
+        const uint32_t gm = m_masters[0].level;
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<uint8_t>((in[i] * gm + round) >> SHIFT);
+        }
+        return;
+    }
+    const uint16_t *scale = univ->scale;
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>((in[i] * uint32_t(scale[i]) + round) >> SHIFT);
+    }
+}
+
+//////////////////////////////////////////////////////////
+void OutputMasters::rebuild(UniverseMasters &univ)
+{
+    constexpr uint32_t round = 1u << (SHIFT - 1);
+    const uint16_t gm = m_masters[0].level;
+    std::fill(std::begin(univ.scale), std::end(univ.scale), gm);
+    univ.full = (FULL == gm);
+    for (unsigned int sub = 1; sub < COUNT; ++sub) {
+        const uint32_t level = m_masters[sub].level;
+        if (0 == (univ.subs & (uint32_t(1) << (sub - 1))) || FULL == level) {
+            continue;
+        }
+        univ.full = false;
+        const auto &channels = univ.channels[sub - 1];
+        for (size_t ch = 0; ch < channels.size(); ++ch) {
+            if (channels.test(ch)) {
+                univ.scale[ch] = static_cast<uint16_t>((univ.scale[ch] * level + round) >> SHIFT);
+            }
+        }
+    }
+    univ.version = m_version;
+}
+
+//////////////////////////////////////////////////////////
+OutputMasters::UniverseMasters *OutputMasters::find(uint32_t universe)
+{
+    auto it = m_universes.find(universe);
+    return (it != m_universes.end()) ? &it->second : nullptr;
+}
@@ -0,0 +1,107 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems output masters header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef OUTPUTMASTERS_H
+#define OUTPUTMASTERS_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// Grand master and submasters: the last stage before a frame goes out.
+// Levels are Q15 fixed point (FULL = 1.0). A channel's output is its
+// rendered value times the grand master times every submaster it is
+// assigned to, so dimming never touches the rendered (cue) values and
+// returning to full restores them exactly.
+//
+// Master 0 is the grand master, 1..SUBMASTER_COUNT the submasters. Level
+// changes may fade, timed by the steady clock. Render thread only; the
+// OSC thread reaches it through the control queue.
+class OutputMasters
+{
+    public:
+        static constexpr unsigned int SHIFT = 15;
+        static constexpr uint16_t FULL = 1u << SHIFT;
+        static constexpr unsigned int COUNT = CuemsConstants::SUBMASTER_COUNT + 1;
+        static_assert(COUNT <= 64, "fading masters are kept in a 64-bit mask");
+        static_assert(CuemsConstants::SUBMASTER_COUNT <= 32, "assigned submasters are kept in a 32-bit mask");
+
+        static uint16_t fromFloat(float level);
+
+        void setLevel(unsigned int master, uint16_t level, int64_t fadeUs, int64_t nowUs);
+        uint16_t level(unsigned int master) const { return m_masters[master].level; }
+
+        // Add (or with on false, remove) channels first..first+count-1 of a
+        // universe to a submaster
+        void assign(unsigned int sub, uint32_t universe, unsigned int first, unsigned int count, bool on);
+
+        // Advance running fades to nowUs; true if a level changed
+        bool update(int64_t nowUs);
+        bool fading() const { return 0 != m_fading; }
+
+        // The universe goes out as rendered
+        bool isFull(uint32_t universe);
+
+        // out[i] = in[i] scaled by the masters of channel i
+        void apply(uint32_t universe, const uint8_t *in, uint8_t *out, size_t size);
+
+    private:
+        struct Master
+        {
+            uint16_t level = FULL;
+            uint16_t level0 = FULL;     // fade from
+            uint16_t level1 = FULL;     // fade to
+            int64_t us0 = 0;
+            int64_t us1 = 0;
+        };
+
+        // Submaster assignments of one universe and the per-channel scale
+        // they give, rebuilt when a level or an assignment changes
+        struct UniverseMasters
+        {
+            std::bitset<CuemsConstants::DMX_CHANNELS_PER_UNIVERSE> channels[CuemsConstants::SUBMASTER_COUNT];
+            uint32_t subs = 0;          // bit n-1: submaster n has channels here
+            uint16_t scale[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+            bool full = true;
+            uint64_t version = 0;       // m_version the scale was built for
+        };
+
+        void rebuild(UniverseMasters &univ);
+        UniverseMasters *find(uint32_t universe);
+
+        Master m_masters[COUNT];
+        uint64_t m_fading = 0;          // bit n: master n is fading
+        std::map<uint32_t, UniverseMasters> m_universes;
+        uint64_t m_version = 1;
+};
+
+#endif // OUTPUTMASTERS_H
@@ -0,0 +1,73 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems render / output thread queue header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef OUTPUTQUEUE_H
+#define OUTPUTQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// What the render thread and the output (I/O) thread tell each other. The
+// render thread asks for frames to be sent and universes to be fetched;
+// the I/O thread, which runs the output's SelectServer, answers with the
+// completion of every frame and the fetched universes.
+//
+// generation is the output connection the message belongs to: after a
+// reconnect, whatever is still queued for the previous one is dropped.
+struct OutputMessage
+{
+    enum class Type : uint8_t { Frame, Fetch,           // render -> I/O
+                                FrameDone, Fetched };   // I/O -> render
+
+    Type type = Type::Frame;
+    bool ok = false;                   // FrameDone, Fetched
+    uint16_t size = 0;                 // bytes of data for Frame, Fetched
+    uint32_t universe = 0;
+    uint32_t generation = 0;
+    uint8_t data[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+};
+
+//////////////////////////////////////////////////////////
+// Fixed single-producer, single-consumer ring; one per direction.
+// push() fails when the ring is full.
+class OutputQueue
+{
+    public:
+        bool push(const OutputMessage &message);
+        bool pop(OutputMessage &message);
+
+    private:
+        OutputMessage m_ring[CuemsConstants::OUTPUT_QUEUE_CAPACITY];
+        std::atomic<uint32_t> m_head{0};   // next slot to write (producer)
+        std::atomic<uint32_t> m_tail{0};   // next slot to read (consumer)
+};
+
+#endif // OUTPUTQUEUE_H
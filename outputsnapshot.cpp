@@ -0,0 +1,199 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems persistent output snapshot code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "outputsnapshot.h"
+#include "./cuemslogger/cuemslogger.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//////////////////////////////////////////////////////////
+OutputSnapshot::~OutputSnapshot()
+{
+    close();
+}
+
+//////////////////////////////////////////////////////////
+bool OutputSnapshot::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        CuemsLogger::getLogger()->logWarning("Snapshot: cannot open " + path + ": " + std::strerror(errno));
+        return false;
+    }
+
+    // A file of the wrong size comes from another layout: start from zeros
+    struct stat st;
+    bool fresh = (0 != fstat(fd, &st)) || (static_cast<size_t>(st.st_size) != mapSize());
+    if (fresh && (0 != ftruncate(fd, 0) || 0 != ftruncate(fd, mapSize()))) {
+        CuemsLogger::getLogger()->logWarning("Snapshot: cannot size " + path + ": " + std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, mapSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == map) {
+        CuemsLogger::getLogger()->logWarning("Snapshot: cannot map " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    m_map = static_cast<uint8_t *>(map);
+
+    Header *header = reinterpret_cast<Header *>(m_map);
+    if (header->magic != MAGIC || header->version != VERSION
+        || header->slotCount != CuemsConstants::SNAPSHOT_MAX_UNIVERSES
+        || header->slotSize != sizeof(Slot)) {
+        std::memset(m_map, 0, mapSize());
+        header->magic = MAGIC;
+        header->version = VERSION;
+        header->slotCount = CuemsConstants::SNAPSHOT_MAX_UNIVERSES;
+        header->slotSize = sizeof(Slot);
+    }
+
+    // Universes keep the slot they had in the previous run. A slot torn by
+    // a crash mid-write is dropped and its counter made even again, so the
+    // next write to it does not leave it reading as torn.
+    m_releases = 0;
+    Slot *s = slots();
+    for (unsigned int i = 0; i < CuemsConstants::SNAPSHOT_MAX_UNIVERSES; ++i) {
+        uint32_t seq = s[i].seq.load(std::memory_order_relaxed);
+        if (seq & 1) {
+            CuemsLogger::getLogger()->logWarning("Snapshot: slot " + std::to_string(i)
+                + " was torn by a crash mid-write, universe " + std::to_string(s[i].id) + " not restored");
+            s[i].used = 0;
+            s[i].seq.store(seq + 1, std::memory_order_relaxed);
+        }
+        m_owners[i] = SlotOwner();
+        m_owners[i].id = s[i].id;
+    }
+
+    CuemsLogger::getLogger()->logInfo("Snapshot: mapped " + path);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void OutputSnapshot::close()
+{
+    if (m_map != nullptr) {
+        munmap(m_map, mapSize());
+        m_map = nullptr;
+    }
+}
+
+//////////////////////////////////////////////////////////
+std::vector<OutputSnapshot::Universe> OutputSnapshot::restore() const
+{
+    std::vector<Universe> result;
+    if (m_map == nullptr) {
+        return result;
+    }
+
+    const Slot *s = slots();
+    for (unsigned int i = 0; i < CuemsConstants::SNAPSHOT_MAX_UNIVERSES; ++i) {
+        uint32_t seq0 = s[i].seq.load(std::memory_order_acquire);
+        if ((seq0 & 1) || !s[i].used) {
+            continue;       // Being written, or never used
+        }
+
+        Universe u;
+        u.id = s[i].id;
+        u.head = s[i].head;
+        std::memcpy(u.values, s[i].values, sizeof(u.values));
+        uint32_t count = std::min<uint32_t>(s[i].transitionCount,
+            CuemsConstants::DMX_CHANNELS_PER_UNIVERSE);
+        u.transitions.assign(s[i].transitions, s[i].transitions + count);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s[i].seq.load(std::memory_order_relaxed) != seq0) {
+            continue;
+        }
+        result.push_back(std::move(u));
+    }
+    return result;
+}
+
+//////////////////////////////////////////////////////////
+// The slot the universe already has, else a free one, else the one released
+// longest ago (its universe will no longer be restored)
+OutputSnapshot::Slot *OutputSnapshot::slotFor(uint32_t id)
+{
+    if (m_map == nullptr) {
+        return nullptr;
+    }
+
+    Slot *s = slots();
+    int found = -1;
+    for (unsigned int i = 0; i < CuemsConstants::SNAPSHOT_MAX_UNIVERSES; ++i) {
+        if (s[i].used && m_owners[i].id == id) {
+            found = i;
+            break;
+        }
+        if (m_owners[i].held) {
+            continue;
+        }
+        if (!s[i].used) {
+            if (found < 0 || s[found].used) {
+                found = i;
+            }
+        }
+        else if (found < 0 || (s[found].used && m_owners[i].released < m_owners[found].released)) {
+            found = i;
+        }
+    }
+
+    if (found < 0) {
+        return nullptr;
+    }
+    m_owners[found].id = id;
+    m_owners[found].held = true;
+    return &s[found];
+}
+
+//////////////////////////////////////////////////////////
+void OutputSnapshot::release(uint32_t id)
+{
+    if (m_map == nullptr) {
+        return;
+    }
+
+    const Slot *s = slots();
+    for (unsigned int i = 0; i < CuemsConstants::SNAPSHOT_MAX_UNIVERSES; ++i) {
+        if (m_owners[i].held && s[i].used && m_owners[i].id == id) {
+            m_owners[i].held = false;
+            m_owners[i].released = ++m_releases;
+            return;
+        }
+    }
+}
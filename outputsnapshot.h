@@ -0,0 +1,187 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems persistent output snapshot header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef OUTPUTSNAPSHOT_H
+#define OUTPUTSNAPSHOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// Memory-mapped copy of the rendered output (universe buffers and in-flight
+// transitions) that outlives the process. The render loop publishes into
+// the shared mapping with plain stores, so there are no syscalls per frame;
+// the page cache keeps the data through a crash, /quit or engine respawn
+// and the next player restores it before its first frame.
+//
+// Transitions are stamped on the play-head; each slot keeps the head it
+// was published at, so a player whose clock restarted can move them onto
+// its own timeline.
+//
+// Each universe holds a slot guarded by a sequence counter (seqlock): odd
+// while the slot is being written, even when it is consistent. A crash in
+// the middle of a write leaves the counter odd; open() discards that slot
+// and the others are still restored.
+//
+// A universe that retires releases its slot. The slot keeps its last frame,
+// so it is still restored after a restart, until another universe needs a
+// slot and none is free: the slot released longest ago is reused then.
+// Slots of the previous run count as released until published again.
+//
+// publish() and release() are called from the render thread only; open()
+// and restore() before the render loop starts.
+class OutputSnapshot
+{
+    public:
+        struct Transition
+        {
+            int64_t mtc0;
+            int64_t mtc1;
+            uint16_t channel;
+            uint8_t val0;
+            uint8_t val1;
+        };
+
+        struct Universe
+        {
+            uint32_t id = 0;
+            int64_t head = 0;       // play-head (ms) the transitions were published at
+            uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE] = {};
+            std::vector<Transition> transitions;
+        };
+
+        OutputSnapshot() = default;
+        ~OutputSnapshot();
+        OutputSnapshot(const OutputSnapshot &) = delete;
+        OutputSnapshot &operator=(const OutputSnapshot &) = delete;
+
+        // Map (creating or re-initializing if needed) the snapshot file
+        bool open(const std::string &path);
+        void close();
+        bool isOpen() const { return m_map != nullptr; }
+
+        // Consistent universes found in the file
+        std::vector<Universe> restore() const;
+
+        // Publish one universe as of play-head head (ms), the timeline of
+        // the transitions' mtc0/mtc1. fill(Transition *out, size_t max) writes the
+        // in-flight transitions straight into the slot and returns how many.
+        // False when no slot is free for it; nothing is logged here, as the
+        // caller is the render thread.
+        template <typename Fill>
+        bool publish(uint32_t id, int64_t head, const uint8_t *values, unsigned int size, Fill &&fill);
+
+        // The universe retired: its slot may be reused
+        void release(uint32_t id);
+
+    private:
+        static constexpr uint64_t MAGIC = 0x584d44534d455543ULL;   // "CUEMSDMX" on disk
+        static constexpr uint32_t VERSION = 2;
+
+        struct Slot
+        {
+            std::atomic<uint32_t> seq;
+            uint32_t id;
+            uint32_t used;
+            uint32_t transitionCount;
+            int64_t head;
+            uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+            Transition transitions[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+        };
+
+        struct Header
+        {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t slotCount;
+            uint32_t slotSize;
+            uint32_t reserved;
+        };
+
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "seqlock counter must be lock-free to live in a shared mapping");
+
+        static constexpr size_t mapSize() {
+            return sizeof(Header) + CuemsConstants::SNAPSHOT_MAX_UNIVERSES * sizeof(Slot);
+        }
+        Slot *slots() const { return reinterpret_cast<Slot *>(m_map + sizeof(Header)); }
+        Slot *slotFor(uint32_t id);
+
+        // Who has each slot, kept in fixed arrays so publishing a universe
+        // never allocates
+        struct SlotOwner
+        {
+            uint32_t id = 0;            // valid while the slot is used
+            bool held = false;          // by a universe being published
+            uint64_t released = 0;      // release order, 0 for the previous run
+        };
+
+        uint8_t *m_map = nullptr;
+        SlotOwner m_owners[CuemsConstants::SNAPSHOT_MAX_UNIVERSES];
+        uint64_t m_releases = 0;
+};
+
+//////////////////////////////////////////////////////////
+template <typename Fill>
+bool OutputSnapshot::publish(uint32_t id, int64_t head, const uint8_t *values, unsigned int size, Fill &&fill)
+{
+    if (m_map == nullptr) {
+        return true;
+    }
+    Slot *slot = slotFor(id);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    // Always even here (open() resets torn slots), but never let an odd
+    // counter turn a finished write into one that reads as in progress
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed) & ~1u;
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->id = id;
+    slot->used = 1;
+    slot->head = head;
+    if (size > CuemsConstants::DMX_CHANNELS_PER_UNIVERSE) {
+        size = CuemsConstants::DMX_CHANNELS_PER_UNIVERSE;
+    }
+    std::copy(values, values + size, slot->values);
+    std::fill(slot->values + size, slot->values + CuemsConstants::DMX_CHANNELS_PER_UNIVERSE, 0);
+    slot->transitionCount = static_cast<uint32_t>(
+        fill(slot->transitions, static_cast<size_t>(CuemsConstants::DMX_CHANNELS_PER_UNIVERSE)));
+
+    slot->seq.store(seq + 2, std::memory_order_release);
+    return true;
+}
+
+#endif // OUTPUTSNAPSHOT_H
@@ -0,0 +1,82 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems published output state code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "outputstate.h"
+#include <algorithm>
+
+//////////////////////////////////////////////////////////
+OutputState::Universe *OutputState::universe(uint32_t id)
+{
+    Universe *end = universes + universeCount;
+    Universe *pos = std::lower_bound(universes, end, id,
+        [](const Universe &u, uint32_t key) { return u.id < key; });
+    if (pos != end && pos->id == id) {
+        return pos;
+    }
+    if (universeCount == CuemsConstants::STATE_MAX_UNIVERSES) {
+        return nullptr;
+    }
+    std::move_backward(pos, end, end + 1);
+    *pos = Universe();
+    pos->id = id;
+    ++universeCount;
+    return pos;
+}
+
+//////////////////////////////////////////////////////////
+const OutputState::Universe *OutputState::find(uint32_t id) const
+{
+    const Universe *end = universes + universeCount;
+    const Universe *pos = std::lower_bound(universes, end, id,
+        [](const Universe &u, uint32_t key) { return u.id < key; });
+    return (pos != end && pos->id == id) ? pos : nullptr;
+}
+
+//////////////////////////////////////////////////////////
+void OutputStateBuffer::publish(const OutputState &state)
+{
+    OutputState &back = m_buffers[m_back];
+    back.frame = state.frame;
+    back.playHead = state.playHead;
+    back.pendingScenes = state.pendingScenes;
+    back.universeCount = state.universeCount;
+    std::copy(state.universes, state.universes + state.universeCount, back.universes);
+
+    m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+//////////////////////////////////////////////////////////
+const OutputState &OutputStateBuffer::acquire()
+{
+    if (m_middle.load(std::memory_order_relaxed) & FRESH) {
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    return m_buffers[m_front];
+}
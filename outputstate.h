@@ -0,0 +1,88 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems published output state header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef OUTPUTSTATE_H
+#define OUTPUTSTATE_H
+
+#include <atomic>
+#include <cstdint>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// What the player is outputting, as of one render tick. Universes are kept
+// sorted by id; a universe that finished fading keeps its last frame.
+struct OutputState
+{
+    struct Universe
+    {
+        uint32_t id = 0;
+        int32_t state = 0;              // ActiveUniverse fetch state
+        uint16_t fades = 0;             // channel transitions running
+        uint16_t effects = 0;
+        uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE] = {};
+    };
+
+    uint64_t frame = 0;                 // render ticks published so far
+    int64_t playHead = 0;
+    uint32_t pendingScenes = 0;
+    uint32_t universeCount = 0;
+    Universe universes[CuemsConstants::STATE_MAX_UNIVERSES];
+
+    // Entry for a universe, inserted in order if missing. nullptr when
+    // the table is full.
+    Universe *universe(uint32_t id);
+    const Universe *find(uint32_t id) const;
+};
+
+//////////////////////////////////////////////////////////
+// Triple buffer handing OutputState from the render thread (publish()) to
+// one reader thread (acquire()) without locks: the writer fills a private
+// back buffer and swaps it with the shared middle one, the reader swaps its
+// front buffer with the middle one only when a newer frame is there. Neither
+// side ever waits for the other, so monitoring cannot delay a render tick.
+class OutputStateBuffer
+{
+    public:
+        // Render thread: copy state into the back buffer and publish it
+        void publish(const OutputState &state);
+
+        // Reader thread: latest published state, valid until the next call
+        const OutputState &acquire();
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 0x3;
+        static constexpr uint8_t FRESH = 0x4;  // middle holds an unread frame
+
+        OutputState m_buffers[3];
+        std::atomic<uint8_t> m_middle{1};
+        uint8_t m_back = 0;             // writer only
+        uint8_t m_front = 2;            // reader only
+};
+
+#endif // OUTPUTSTATE_H
@@ -0,0 +1,242 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems patch table code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "patchtable.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+struct Route
+{
+    uint32_t logicalUniverse;
+    uint16_t logicalChannel;
+    uint32_t physicalUniverse;
+    uint16_t physicalChannel;
+};
+
+bool validUniverse(long v) { return v >= CuemsConstants::MIN_UNIVERSE_ID && v <= CuemsConstants::MAX_UNIVERSE_ID; }
+bool validChannel(long v) { return v >= CuemsConstants::MIN_CHANNEL_ID && v < CuemsConstants::DMX_CHANNELS_PER_UNIVERSE; }
+
+}
+
+//////////////////////////////////////////////////////////
+// Lines for the same logical channel add outputs; when two lines target
+// the same physical channel the later one wins.
+bool PatchTable::load(const std::string &path)
+{
+    m_path = path;
+    m_error.clear();
+
+    std::ifstream file(path);
+    if (!file) {
+        m_error = "cannot open " + path;
+        return false;
+    }
+
+    std::vector<Route> routes;
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        long lu = 0, lc = 0;
+        if (!(fields >> lu)) {
+            continue;       // blank or comment
+        }
+        std::string where = path + ":" + std::to_string(number) + ": ";
+        if (!(fields >> lc) || !validUniverse(lu) || !validChannel(lc)) {
+            m_error = where + "bad logical universe or channel";
+            return false;
+        }
+        size_t outputs = 0;
+        long pu = 0, pc = 0;
+        while (fields >> pu) {
+            if (!(fields >> pc) || !validUniverse(pu) || !validChannel(pc)) {
+                m_error = where + "bad physical universe or channel";
+                return false;
+            }
+            routes.push_back({static_cast<uint32_t>(lu), static_cast<uint16_t>(lc),
+                              static_cast<uint32_t>(pu), static_cast<uint16_t>(pc)});
+            ++outputs;
+        }
+        if (!fields.eof() || 0 == outputs) {
+            m_error = where + "expected <universe> <channel> followed by physical <universe> <channel> pairs";
+            return false;
+        }
+    }
+
+    // Logical and physical universes, sorted
+    m_logical.clear();
+    m_physical.clear();
+    std::vector<uint32_t> logicalIds, physicalIds;
+    for (const auto &r : routes) {
+        logicalIds.push_back(r.logicalUniverse);
+        physicalIds.push_back(r.physicalUniverse);
+    }
+    for (auto *ids : {&logicalIds, &physicalIds}) {
+        std::sort(ids->begin(), ids->end());
+        ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+    }
+    m_logical.resize(logicalIds.size());
+    for (size_t i = 0; i < logicalIds.size(); ++i) {
+        m_logical[i].universe = logicalIds[i];
+    }
+    m_physical.resize(physicalIds.size());
+    for (size_t i = 0; i < physicalIds.size(); ++i) {
+        Physical &phys = m_physical[i];
+        phys.universe = physicalIds[i];
+        std::fill(std::begin(phys.gather), std::end(phys.gather), UNPATCHED);
+        phys.buffer.Blackout();
+    }
+
+    // Gather indices: source slot of the logical universe, then channel
+    std::vector<std::vector<uint32_t>> targets(m_logical.size());
+    for (const auto &r : routes) {
+        uint32_t logical = findLogical(r.logicalUniverse);
+        Physical &phys = *findPhysical(r.physicalUniverse);
+        uint32_t *end = phys.sources + phys.sourceCount;
+        uint32_t *slot = std::find(phys.sources, end, logical);
+        if (slot == end) {
+            if (CuemsConstants::PATCH_MAX_SOURCES == phys.sourceCount) {
+                m_error = path + ": physical universe " + std::to_string(phys.universe) + " is fed by more than "
+                    + std::to_string(CuemsConstants::PATCH_MAX_SOURCES) + " logical universes";
+                return false;
+            }
+            phys.sources[phys.sourceCount++] = logical;
+            targets[logical].push_back(&phys - m_physical.data());
+        }
+        phys.gather[r.physicalChannel] = (slot - phys.sources) * CHANNELS + r.logicalChannel;
+    }
+
+    m_targets.clear();
+    for (size_t i = 0; i < m_logical.size(); ++i) {
+        m_logical[i].targetsBegin = m_targets.size();
+        m_targets.insert(m_targets.end(), targets[i].begin(), targets[i].end());
+        m_logical[i].targetsEnd = m_targets.size();
+    }
+    m_frames.assign(m_logical.size() * CHANNELS, 0);
+    m_entries = routes.size();
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+int PatchTable::findLogical(uint32_t universe) const
+{
+    auto it = std::lower_bound(m_logical.begin(), m_logical.end(), universe,
+        [](const Logical &l, uint32_t id) { return l.universe < id; });
+    return (it != m_logical.end() && it->universe == universe) ? it - m_logical.begin() : -1;
+}
+
+//////////////////////////////////////////////////////////
+PatchTable::Physical *PatchTable::findPhysical(uint32_t universe)
+{
+    return const_cast<Physical *>(static_cast<const PatchTable *>(this)->findPhysical(universe));
+}
+
+//////////////////////////////////////////////////////////
+const PatchTable::Physical *PatchTable::findPhysical(uint32_t universe) const
+{
+    auto it = std::lower_bound(m_physical.begin(), m_physical.end(), universe,
+        [](const Physical &p, uint32_t id) { return p.universe < id; });
+    return (it != m_physical.end() && it->universe == universe) ? &*it : nullptr;
+}
+
+//////////////////////////////////////////////////////////
+const uint8_t *PatchTable::frame(uint32_t universe) const
+{
+    int index = findLogical(universe);
+    return (0 <= index && m_logical[index].known) ? sourceFrame(index) : nullptr;
+}
+
+//////////////////////////////////////////////////////////
+bool PatchTable::storeFrame(uint32_t universe, const uint8_t *data, size_t size)
+{
+    int index = findLogical(universe);
+    if (index < 0) {
+        return false;
+    }
+    Logical &logical = m_logical[index];
+    std::memcpy(&m_frames[index * CHANNELS], data, std::min(size, CHANNELS));
+    logical.known = true;
+    for (uint32_t t = logical.targetsBegin; t < logical.targetsEnd; ++t) {
+        m_physical[m_targets[t]].dirty = true;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void PatchTable::adopt(const PatchTable &previous)
+{
+    for (size_t i = 0; i < m_logical.size(); ++i) {
+        if (const uint8_t *data = previous.frame(m_logical[i].universe)) {
+            std::memcpy(&m_frames[i * CHANNELS], data, CHANNELS);
+            m_logical[i].known = true;
+        }
+    }
+    for (auto &phys : m_physical) {
+        if (const Physical *old = previous.findPhysical(phys.universe)) {
+            phys.inFlight = old->inFlight;
+        }
+    }
+    resend();
+}
+
+//////////////////////////////////////////////////////////
+void PatchTable::resend()
+{
+    for (auto &phys : m_physical) {
+        for (unsigned int s = 0; s < phys.sourceCount; ++s) {
+            phys.dirty = phys.dirty || m_logical[phys.sources[s]].known;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////
+void PatchTable::blackout()
+{
+    std::fill(m_frames.begin(), m_frames.end(), 0);
+    for (auto &logical : m_logical) {
+        logical.known = true;
+    }
+    for (auto &phys : m_physical) {
+        phys.dirty = true;
+    }
+}
+
+//////////////////////////////////////////////////////////
+void PatchTable::gather(const Physical &physical, const uint8_t *staging, uint8_t *out)
+{
+    const uint16_t *index = physical.gather;
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        out[i] = staging[index[i]];
+    }
+}
@@ -0,0 +1,129 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems patch table header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef PATCHTABLE_H
+#define PATCHTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ola/DmxBuffer.h>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// Logical-to-physical patch. Cues address logical (universe, channel)
+// pairs; the patch sends each patched logical channel to one or more
+// physical (universe, channel) outputs. The file has one line per logical
+// channel, '#' starts a comment:
+//
+//   <logical universe> <logical channel> <physical universe> <physical channel> [...]
+//
+// load() compiles it, on the OSC thread, into one gather index array per
+// physical universe: every physical channel names the byte it is copied
+// from in a staging area holding the physical universe's source logical
+// frames side by side, so building a frame is one pass whatever the
+// number of outputs per channel. Physical channels nothing is patched to
+// read a zero byte.
+//
+// The table also keeps the latest frame of every patched logical universe
+// (cue values, before the masters), so a physical universe can be rebuilt
+// when any of its sources changes, and so the frames survive a reload.
+// Everything past load() is for the render thread and does not allocate.
+class PatchTable
+{
+    public:
+        static constexpr size_t CHANNELS = CuemsConstants::DMX_CHANNELS_PER_UNIVERSE;
+        static constexpr size_t STAGING_SIZE = CuemsConstants::PATCH_MAX_SOURCES * CHANNELS + 1;
+        static constexpr uint16_t UNPATCHED = STAGING_SIZE - 1;   // the zero byte
+        static_assert(STAGING_SIZE <= 65536, "gather indices are 16-bit");
+
+        struct Physical
+        {
+            uint32_t universe = 0;
+            uint32_t sources[CuemsConstants::PATCH_MAX_SOURCES];  // logical indices
+            unsigned int sourceCount = 0;
+            uint16_t gather[CHANNELS];
+            ola::DmxBuffer buffer;          // the frame last built
+            bool dirty = false;             // a source changed since
+            uint8_t inFlight = 0;           // frames not yet acknowledged
+        };
+
+        bool load(const std::string &path);
+        const std::string &lastError() const { return m_error; }
+        const std::string &path() const { return m_path; }
+        size_t entries() const { return m_entries; }
+
+        bool isLogical(uint32_t universe) const { return 0 <= findLogical(universe); }
+        bool isPhysical(uint32_t universe) const { return findPhysical(universe) != nullptr; }
+        Physical *findPhysical(uint32_t universe);
+        const Physical *findPhysical(uint32_t universe) const;
+        std::vector<Physical> &physical() { return m_physical; }
+
+        // Latest frame of a patched logical universe; nullptr when it is
+        // not patched or no frame is known yet
+        const uint8_t *frame(uint32_t universe) const;
+        const uint8_t *sourceFrame(uint32_t index) const { return &m_frames[index * CHANNELS]; }
+        uint32_t sourceUniverse(uint32_t index) const { return m_logical[index].universe; }
+
+        // Keep a logical frame and mark its physical universes dirty. False
+        // if the universe is not patched (it goes out as it is).
+        bool storeFrame(uint32_t universe, const uint8_t *data, size_t size);
+
+        // Take over the frames an older table knew, and the frames still in
+        // flight of its physical universes; then resend()
+        void adopt(const PatchTable &previous);
+        // Mark the physical universes with a known source dirty
+        void resend();
+        void blackout();
+
+        // out[i] = staging[gather[i]] for one physical universe
+        static void gather(const Physical &physical, const uint8_t *staging, uint8_t *out);
+
+    private:
+        struct Logical
+        {
+            uint32_t universe = 0;
+            uint32_t targetsBegin = 0;      // into m_targets
+            uint32_t targetsEnd = 0;
+            bool known = false;
+        };
+
+        int findLogical(uint32_t universe) const;
+
+        std::string m_path;
+        std::string m_error;
+        size_t m_entries = 0;
+        std::vector<Logical> m_logical;     // sorted by universe
+        std::vector<uint8_t> m_frames;      // CHANNELS per logical universe
+        std::vector<uint32_t> m_targets;    // physical indices, by logical universe
+        std::vector<Physical> m_physical;   // sorted by universe
+};
+
+#endif // PATCHTABLE_H
@@ -0,0 +1,110 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems play-head tracker (software PLL) code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "playheadtracker.h"
+#include "cuems_constants.h"
+#include <algorithm>
+#include <cmath>
+
+//////////////////////////////////////////////////////////
+long int PlayHeadTracker::update(long int rawHead, int64_t nowUs)
+{
+    double dt = (nowUs - m_lastUs) / 1000.0;
+    if (!m_locked || dt <= 0 || dt > CuemsConstants::PLAYHEAD_MAX_GAP_MS) {
+        relock(rawHead, nowUs);
+        return m_lastOut;
+    }
+
+    double predicted = m_phase + m_rate * dt;
+    double err = rawHead - predicted;
+    if (std::fabs(err) > CuemsConstants::PLAYHEAD_RELOCK_THRESHOLD_MS) {
+        relock(rawHead, nowUs);
+        return m_lastOut;
+    }
+
+    // Second-order PI loop, slightly underdamped (zeta = 0.707: settles
+    // fastest with about 4% overshoot). Gains scale with dt so the response
+    // does not depend on the tick interval (10 ms active, 200 ms idle).
+    constexpr double wn = 2.0 * M_PI * CuemsConstants::PLAYHEAD_PLL_BANDWIDTH_HZ / 1000.0;
+    constexpr double zeta = 0.707;
+    double kp = std::min(1.0, 2.0 * zeta * wn * dt);
+    double ki = wn * wn * dt;
+
+    // Bounded slew: the phase correction never exceeds a fixed fraction of
+    // the elapsed real time, so fades speed up or slow down imperceptibly.
+    double maxCorr = CuemsConstants::PLAYHEAD_MAX_SLEW * dt;
+    double corr = std::clamp(kp * err, -maxCorr, maxCorr);
+
+    m_phase = predicted + corr;
+    m_rate = std::clamp(m_rate + ki * err,
+                        1.0 - CuemsConstants::PLAYHEAD_MAX_RATE_DEVIATION,
+                        1.0 + CuemsConstants::PLAYHEAD_MAX_RATE_DEVIATION);
+    m_lastUs = nowUs;
+
+    // Monotonic output: hold rather than step back inside the lock range
+    long int out = std::lround(m_phase);
+    if (out > m_lastOut) {
+        m_lastOut = out;
+    }
+
+    m_residualMs.store(err, std::memory_order_relaxed);
+    double avg = m_avgAbsResidualMs.load(std::memory_order_relaxed);
+    m_avgAbsResidualMs.store(avg + 0.05 * (std::fabs(err) - avg), std::memory_order_relaxed);
+    m_driftPpm.store((m_rate - 1.0) * 1e6, std::memory_order_relaxed);
+
+    return m_lastOut;
+}
+
+//////////////////////////////////////////////////////////
+void PlayHeadTracker::relock(long int rawHead, int64_t nowUs)
+{
+    // Keep the learnt rate across discontinuities: a locate does not
+    // change the speed of the timecode source
+    if (!m_locked) {
+        m_rate = 1.0;
+    }
+    m_locked = true;
+    m_phase = rawHead;
+    m_lastUs = nowUs;
+    m_lastOut = rawHead;
+    m_residualMs.store(0, std::memory_order_relaxed);
+    m_relocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////
+PlayHeadTracker::Metrics PlayHeadTracker::metrics() const
+{
+    Metrics m;
+    m.residualMs = m_residualMs.load(std::memory_order_relaxed);
+    m.avgAbsResidualMs = m_avgAbsResidualMs.load(std::memory_order_relaxed);
+    m.driftPpm = m_driftPpm.load(std::memory_order_relaxed);
+    m.relocks = m_relocks.load(std::memory_order_relaxed);
+    return m;
+}
@@ -0,0 +1,81 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems play-head tracker (software PLL) header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef PLAYHEADTRACKER_H
+#define PLAYHEADTRACKER_H
+
+#include <atomic>
+#include <cstdint>
+
+//////////////////////////////////////////////////////////
+// Clock-recovery stage between MtcReceiver::estimatedCurrentHead() and the
+// render loop. Networked MTC (rtpmidid) delivers quarter frames with jitter,
+// so the raw head steps back and forth by a few ms from tick to tick. This
+// second-order PLL tracks the MTC phase and rate and outputs a play-head
+// that never runs backwards and only slews by a bounded fraction of real
+// time, re-locking hard when the raw head jumps (locate, loop, restart).
+//
+// update() and reset() are called from the render thread only; metrics()
+// may be read from any thread.
+class PlayHeadTracker
+{
+    public:
+        struct Metrics
+        {
+            double residualMs = 0;      // Last raw - predicted phase error
+            double avgAbsResidualMs = 0; // Smoothed |residual|
+            double driftPpm = 0;        // Tracked MTC rate vs. local clock
+            uint64_t relocks = 0;       // Hard re-locks on discontinuities
+        };
+
+        // Feed a raw head sample (ms) taken at nowUs (steady clock, µs) and
+        // return the smoothed head in ms.
+        long int update(long int rawHead, int64_t nowUs);
+
+        // Drop the lock; the next update() re-locks on the raw head
+        void reset() { m_locked = false; }
+
+        Metrics metrics() const;
+
+    private:
+        void relock(long int rawHead, int64_t nowUs);
+
+        bool m_locked = false;
+        double m_phase = 0;             // ms
+        double m_rate = 1.0;            // MTC ms per local ms
+        int64_t m_lastUs = 0;
+        long int m_lastOut = 0;
+
+        std::atomic<double> m_residualMs {0};
+        std::atomic<double> m_avgAbsResidualMs {0};
+        std::atomic<double> m_driftPpm {0};
+        std::atomic<uint64_t> m_relocks {0};
+};
+
+#endif // PLAYHEADTRACKER_H
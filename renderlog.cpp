@@ -0,0 +1,106 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems deferred render-thread log code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "renderlog.h"
+#include "./cuemslogger/cuemslogger.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+
+//////////////////////////////////////////////////////////
+RenderLog::RenderLog()
+{
+    m_thread = std::thread(&RenderLog::drainLoop, this);
+}
+
+//////////////////////////////////////////////////////////
+RenderLog::~RenderLog()
+{
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+//////////////////////////////////////////////////////////
+void RenderLog::post(Level level, const char *format, ...)
+{
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= CuemsConstants::RENDER_LOG_CAPACITY) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record &rec = m_ring[head % CuemsConstants::RENDER_LOG_CAPACITY];
+    rec.level = level;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(rec.text, sizeof(rec.text), format, args);
+    va_end(args);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////
+void RenderLog::drainLoop()
+{
+    while (!m_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(CuemsConstants::RENDER_LOG_DRAIN_MS));
+        drain();
+    }
+    drain();
+}
+
+//////////////////////////////////////////////////////////
+// Debug lines keep going to stdout like the rest of the player's traces;
+// the others to syslog through CuemsLogger.
+void RenderLog::drain()
+{
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+        const Record &rec = m_ring[tail % CuemsConstants::RENDER_LOG_CAPACITY];
+        switch (rec.level) {
+            case Level::Debug:
+                std::cout << rec.text << std::endl;
+                break;
+            case Level::Info:
+                CuemsLogger::getLogger()->logInfo(rec.text);
+                break;
+            case Level::Warning:
+                CuemsLogger::getLogger()->logWarning(rec.text);
+                break;
+            case Level::Error:
+                CuemsLogger::getLogger()->logError(rec.text);
+                break;
+        }
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,79 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems deferred render-thread log header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef RENDERLOG_H
+#define RENDERLOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "cuems_constants.h"
+
+//////////////////////////////////////////////////////////
+// Log lines from the render thread. post() formats into a fixed ring slot
+// and returns: no allocation, no lock, no write to stdout or syslog, so a
+// slow console or syslog cannot stall a tick. A background thread drains
+// the ring every RENDER_LOG_DRAIN_MS; when the ring is full new lines are
+// dropped and counted.
+//
+// post() must only be called from one thread (the render thread).
+class RenderLog
+{
+    public:
+        enum class Level : uint8_t { Debug, Info, Warning, Error };
+
+        RenderLog();
+        ~RenderLog();
+        RenderLog(const RenderLog &) = delete;
+        RenderLog &operator=(const RenderLog &) = delete;
+
+        void post(Level level, const char *format, ...)
+            __attribute__((format(printf, 3, 4)));
+
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Record
+        {
+            Level level;
+            char text[CuemsConstants::RENDER_LOG_LINE_SIZE];
+        };
+
+        void drainLoop();
+        void drain();
+
+        Record m_ring[CuemsConstants::RENDER_LOG_CAPACITY];
+        std::atomic<uint32_t> m_head{0};   // next slot to write (render thread)
+        std::atomic<uint32_t> m_tail{0};   // next slot to read (drain thread)
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<bool> m_stop{false};
+        std::thread m_thread;
+};
+
+#endif // RENDERLOG_H
@@ -0,0 +1,254 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems show trace recorder code file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "showtrace.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+}
+
+//////////////////////////////////////////////////////////
+ShowTrace::~ShowTrace()
+{
+    close();
+}
+
+//////////////////////////////////////////////////////////
+// The trace of the previous run is kept as <path>.prev: after a crash the
+// respawned player must not overwrite the record of what led to it.
+bool ShowTrace::open(const std::string &path, size_t regionBytes)
+{
+    close();
+    m_error.clear();
+
+    regionBytes = align8(regionBytes);
+    size_t mapSize = regionOffset(REGIONS, regionBytes);
+
+    std::rename(path.c_str(), (path + ".prev").c_str());
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        m_error = std::string("cannot open ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (0 != ftruncate(fd, mapSize)) {
+        m_error = std::string("cannot size ") + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == map) {
+        m_error = std::string("cannot map ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    m_mapSize = mapSize;
+    m_regionBytes = regionBytes;
+
+    Header *header = static_cast<Header *>(map);
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->regionCount = REGIONS;
+    header->regionBytes = regionBytes;
+    m_map.store(static_cast<uint8_t *>(map), std::memory_order_release);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+void ShowTrace::close()
+{
+    uint8_t *map = m_map.exchange(nullptr, std::memory_order_acq_rel);
+    if (map != nullptr) {
+        munmap(map, m_mapSize);
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Bytes taken by the record at position pos. A tail too short for a record
+// header is skipped; writers never leave a zero size, but a damaged file
+// must not loop forever.
+size_t ShowTrace::recordSpan(const uint8_t *data, size_t regionBytes, uint64_t pos)
+{
+    size_t offset = pos % regionBytes;
+    size_t left = regionBytes - offset;
+    if (left < sizeof(RecordHeader)) {
+        return left;
+    }
+    const RecordHeader *rec = reinterpret_cast<const RecordHeader *>(data + offset);
+    if (rec->size < sizeof(RecordHeader) || rec->size > left) {
+        return left;
+    }
+    return rec->size;
+}
+
+//////////////////////////////////////////////////////////
+void ShowTrace::record(Region region, Type type, int64_t timeUs,
+                       const void *data, size_t size, const void *data2, size_t size2)
+{
+    uint8_t *map = m_map.load(std::memory_order_acquire);
+    if (map == nullptr) {
+        return;
+    }
+    size_t total = align8(sizeof(RecordHeader) + size + size2);
+    if (total > m_regionBytes / 2) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t base = regionOffset(static_cast<unsigned int>(region), m_regionBytes);
+    RegionHeader *rh = reinterpret_cast<RegionHeader *>(map + base);
+    uint8_t *ring = map + base + sizeof(RegionHeader);
+
+    uint64_t head = rh->head.load(std::memory_order_relaxed);
+    uint64_t tail = rh->tail.load(std::memory_order_relaxed);
+
+    // Records never wrap: pad out the end of the ring first
+    size_t offset = head % m_regionBytes;
+    if (m_regionBytes - offset < total) {
+        size_t pad = m_regionBytes - offset;
+        while (head + pad - tail > m_regionBytes) {
+            tail += recordSpan(ring, m_regionBytes, tail);
+        }
+        rh->tail.store(tail, std::memory_order_release);
+        if (sizeof(RecordHeader) <= pad) {
+            RecordHeader filler{static_cast<uint32_t>(pad), Type::Pad, 0, timeUs};
+            std::memcpy(ring + offset, &filler, sizeof(filler));
+        }
+        head += pad;
+        rh->head.store(head, std::memory_order_release);
+        offset = 0;
+    }
+
+    // Drop the oldest records until the new one fits
+    while (head + total - tail > m_regionBytes) {
+        tail += recordSpan(ring, m_regionBytes, tail);
+    }
+    rh->tail.store(tail, std::memory_order_release);
+
+    uint16_t padding = static_cast<uint16_t>(total - sizeof(RecordHeader) - size - size2);
+    RecordHeader header{static_cast<uint32_t>(total), type, padding, timeUs};
+    std::memcpy(ring + offset, &header, sizeof(header));
+    if (0 < size) {
+        std::memcpy(ring + offset + sizeof(header), data, size);
+    }
+    if (0 < size2) {
+        std::memcpy(ring + offset + sizeof(header) + size, data2, size2);
+    }
+    rh->head.store(head + total, std::memory_order_release);
+    m_records.fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////
+bool ShowTrace::read(const std::string &path, const std::function<void(const Record &)> &visit)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    size_t mapSize = static_cast<size_t>(st.st_size);
+    void *map = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == map) {
+        return false;
+    }
+    const uint8_t *file = static_cast<const uint8_t *>(map);
+
+    const Header *header = reinterpret_cast<const Header *>(file);
+    size_t regionBytes = header->regionBytes;
+    if (header->magic != MAGIC || header->version != VERSION || header->regionCount != REGIONS
+        || 0 == regionBytes || mapSize < regionOffset(REGIONS, regionBytes)) {
+        munmap(map, mapSize);
+        return false;
+    }
+
+    // Each region is in time order; merge them
+    std::vector<Record> regions[REGIONS];
+    for (unsigned int r = 0; r < REGIONS; ++r) {
+        size_t base = regionOffset(r, regionBytes);
+        const RegionHeader *rh = reinterpret_cast<const RegionHeader *>(file + base);
+        const uint8_t *ring = file + base + sizeof(RegionHeader);
+        uint64_t head = rh->head.load(std::memory_order_acquire);
+        uint64_t pos = rh->tail.load(std::memory_order_acquire);
+        while (pos < head) {
+            size_t span = recordSpan(ring, regionBytes, pos);
+            if (sizeof(RecordHeader) <= span && pos + span <= head) {
+                const RecordHeader *rec = reinterpret_cast<const RecordHeader *>(ring + pos % regionBytes);
+                if (rec->type != Type::Pad && rec->padding < 8
+                    && sizeof(RecordHeader) + rec->padding <= rec->size) {
+                    regions[r].push_back({rec->type, rec->timeUs,
+                        reinterpret_cast<const uint8_t *>(rec + 1),
+                        static_cast<uint32_t>(rec->size - sizeof(RecordHeader) - rec->padding)});
+                }
+            }
+            pos += span;
+        }
+    }
+
+    size_t i = 0, j = 0;
+    const auto &ingest = regions[static_cast<unsigned int>(Region::Ingest)];
+    const auto &render = regions[static_cast<unsigned int>(Region::Render)];
+    while (i < ingest.size() || j < render.size()) {
+        if (j == render.size() || (i < ingest.size() && ingest[i].timeUs <= render[j].timeUs)) {
+            visit(ingest[i++]);
+        }
+        else {
+            visit(render[j++]);
+        }
+    }
+
+    munmap(map, mapSize);
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+uint64_t ShowTrace::frameHash(uint64_t hash, uint32_t universe, const uint8_t *data, size_t size)
+{
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    for (int shift = 0; shift < 32; shift += 8) {
+        hash = (hash ^ ((universe >> shift) & 0xff)) * prime;
+    }
+    for (size_t k = 0; k < size; ++k) {
+        hash = (hash ^ data[k]) * prime;
+    }
+    return hash;
+}
@@ -0,0 +1,150 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems show trace recorder header file
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+#ifndef SHOWTRACE_H
+#define SHOWTRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+//////////////////////////////////////////////////////////
+// Binary trace of a show: every OSC packet received (raw bytes), every
+// render tick (play-head and whether it rendered) and every frame sent,
+// stamped with the steady clock. Records are appended to ring regions in a
+// memory-mapped file, so recording is a copy into the page cache: no
+// syscalls, no allocation, and the trace survives a crash. Once a region
+// is full the oldest records are overwritten.
+//
+// Each region has a single writer: Ingest is written by the OSC thread,
+// Render by the render thread. open() may run while they already call
+// record(): the mapping is published last, once it is set up. close()
+// must not race record(). A region's head only moves past a record
+// once it is complete, so a record cut short by a crash is never read.
+//
+// read() walks a trace file (the player's, after it stopped, or a copy)
+// in time order; tools/dmxreplay feeds it back through a player running
+// with --replay.
+class ShowTrace
+{
+    public:
+        enum class Region : uint8_t { Ingest = 0, Render = 1 };
+        enum class Type : uint16_t { Pad = 0, Packet = 1, Tick = 2, Frame = 3 };
+
+        struct TickInfo
+        {
+            int64_t playHead;
+            uint8_t rendered;       // processScenes() / updateActiveUniverses() ran
+            uint8_t reserved[7];
+        };
+
+        struct Record
+        {
+            Type type;
+            int64_t timeUs;         // steady clock
+            const uint8_t *data;
+            uint32_t size;
+        };
+
+        ShowTrace() = default;
+        ~ShowTrace();
+        ShowTrace(const ShowTrace &) = delete;
+        ShowTrace &operator=(const ShowTrace &) = delete;
+
+        // Create (or re-initialize) the trace file with regionBytes per region
+        bool open(const std::string &path, size_t regionBytes);
+        void close();
+        bool isOpen() const { return m_map.load(std::memory_order_acquire) != nullptr; }
+        const std::string &lastError() const { return m_error; }
+
+        // Append one record made of up to two parts. No-op when not open;
+        // records larger than half a region are dropped and counted.
+        void record(Region region, Type type, int64_t timeUs,
+                    const void *data, size_t size,
+                    const void *data2 = nullptr, size_t size2 = 0);
+
+        uint64_t records() const { return m_records.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        // Calls visit for every record in the file, both regions merged by
+        // time. False if the file is missing or not a trace.
+        static bool read(const std::string &path, const std::function<void(const Record &)> &visit);
+
+        // FNV-1a over a sent frame, chained over the frames of one tick; the
+        // player (in --replay) and dmxreplay compare ticks with it
+        static uint64_t frameHash(uint64_t hash, uint32_t universe, const uint8_t *data, size_t size);
+        static constexpr uint64_t FRAME_HASH_SEED = 0xcbf29ce484222325ULL;
+
+    private:
+        static constexpr uint64_t MAGIC = 0x435254534d455543ULL;   // "CUEMSTRC" on disk
+        static constexpr uint32_t VERSION = 1;
+        static constexpr unsigned int REGIONS = 2;
+
+        struct Header
+        {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t regionCount;
+            uint64_t regionBytes;
+        };
+
+        struct RegionHeader
+        {
+            std::atomic<uint64_t> head;     // byte position after the newest record
+            std::atomic<uint64_t> tail;     // byte position of the oldest record
+            uint64_t reserved[6];
+        };
+
+        struct RecordHeader
+        {
+            uint32_t size;                  // whole record, header and padding included
+            Type type;
+            uint16_t padding;               // bytes after the payload, up to 7
+            int64_t timeUs;
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                      "region positions must be lock-free to live in a shared mapping");
+
+        static size_t recordSpan(const uint8_t *ring, size_t regionBytes, uint64_t pos);
+        static size_t regionOffset(unsigned int region, size_t regionBytes) {
+            return sizeof(Header) + region * (sizeof(RegionHeader) + regionBytes);
+        }
+
+        std::atomic<uint8_t *> m_map{nullptr};           // published by open() once set up
+        size_t m_mapSize = 0;
+        size_t m_regionBytes = 0;
+        std::string m_error;
+        std::atomic<uint64_t> m_records{0};
+        std::atomic<uint64_t> m_dropped{0};
+};
+
+#endif // SHOWTRACE_H
@@ -0,0 +1,217 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX looping sequence test
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "../dmxsequence.h"
+#include "../cuems_constants.h"
+#include "testcheck.h"
+#include <cstdint>
+#include <string>
+
+namespace {
+
+constexpr size_t CHANNELS = CuemsConstants::DMX_CHANNELS_PER_UNIVERSE;
+
+//////////////////////////////////////////////////////////
+// A two step chase on universe 1: channel 0 at full for 100 ms, then a
+// 100 ms fade to channel 1 held for 100 ms. Channel 1 is not set by the
+// first step, so it starts from the universe's value.
+void defineChase(DmxSequence &sequence)
+{
+    sequence.addStep(0, 100);
+    CHECK(sequence.addValue(1, 0, 255));
+    sequence.addStep(100, 100);
+    CHECK(sequence.addValue(1, 0, 0));
+    CHECK(sequence.addValue(1, 1, 255));
+}
+
+//////////////////////////////////////////////////////////
+void compileErrors()
+{
+    std::string error;
+
+    DmxSequence empty("empty");
+    CHECK(!empty.addValue(1, 0, 255));
+    CHECK(!empty.compile(error));
+    CHECK(!error.empty());
+
+    DmxSequence noDuration("no_duration");
+    noDuration.addStep(0, 0);
+    CHECK(noDuration.addValue(1, 0, 255));
+    error.clear();
+    CHECK(!noDuration.compile(error));
+    CHECK(!error.empty());
+
+    DmxSequence noValues("no_values");
+    noValues.addStep(0, 100);
+    error.clear();
+    CHECK(!noValues.compile(error));
+    CHECK(!error.empty());
+
+    DmxSequence tooLong("too_long");
+    for (size_t k = 0; k <= CuemsConstants::SEQUENCE_MAX_STEPS; ++k) {
+        tooLong.addStep(0, 10);
+    }
+    CHECK(tooLong.addValue(1, 0, 255));
+    error.clear();
+    CHECK(!tooLong.compile(error));
+    CHECK(!error.empty());
+}
+
+//////////////////////////////////////////////////////////
+// One track per universe, sorted by universe whatever the order the
+// values came in
+void tracks()
+{
+    DmxSequence sequence("tracks");
+    sequence.addStep(0, 100);
+    CHECK(sequence.addValue(7, 3, 10));
+    CHECK(sequence.addValue(2, 5, 20));
+    CHECK(sequence.addValue(7, 1, 30));
+    std::string error;
+    CHECK(sequence.compile(error));
+    CHECK(1 == sequence.stepCount());
+
+    auto &tracks = sequence.tracks();
+    CHECK(2 == tracks.size());
+    CHECK(2 == tracks[0].universe);
+    CHECK(1 == tracks[0].end - tracks[0].begin);
+    CHECK(7 == tracks[1].universe);
+    CHECK(2 == tracks[1].end - tracks[1].begin);
+}
+
+//////////////////////////////////////////////////////////
+// Step values and fades through two loops, then the end held
+void steps()
+{
+    DmxSequence sequence("chase");
+    defineChase(sequence);
+    std::string error;
+    CHECK(sequence.compile(error));
+    CHECK(2 == sequence.stepCount());
+
+    uint8_t buffer[CHANNELS] = {};
+    buffer[1] = 40;
+    auto &track = sequence.tracks()[0];
+    sequence.start(1000, 2);
+
+    sequence.render(track, 1050, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 40 == buffer[1]);
+
+    // Half way through the fade, channel 1 from its start value
+    sequence.render(track, 1150, buffer, CHANNELS);
+    CHECK(128 == buffer[0] && 148 == buffer[1]);
+
+    sequence.render(track, 1250, buffer, CHANNELS);
+    CHECK(0 == buffer[0] && 255 == buffer[1]);
+
+    // Second loop: channel 1 keeps its value from the end of the loop
+    sequence.render(track, 1350, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 255 == buffer[1]);
+
+    sequence.render(track, 1450, buffer, CHANNELS);
+    CHECK(128 == buffer[0] && 255 == buffer[1]);
+
+    CHECK(!sequence.finished(1599));
+    CHECK(sequence.finished(1600));
+    buffer[0] = 99;
+    sequence.render(track, 1700, buffer, CHANNELS);
+    CHECK(0 == buffer[0] && 255 == buffer[1]);
+
+    // Channels beyond the buffer are left alone
+    uint8_t shortBuffer[1] = {7};
+    sequence.start(2000, 1);
+    sequence.render(track, 2050, shortBuffer, 1);
+    CHECK(255 == shortBuffer[0]);
+}
+
+//////////////////////////////////////////////////////////
+// loops < 0 keeps the defined count, 0 runs until stopped
+void loops()
+{
+    DmxSequence sequence("loops");
+    defineChase(sequence);
+    sequence.setLoops(3);
+    std::string error;
+    CHECK(sequence.compile(error));
+
+    sequence.start(0, -1);
+    CHECK(!sequence.finished(899));
+    CHECK(sequence.finished(900));
+
+    sequence.start(0, 0);
+    CHECK(!sequence.finished(1000000));
+}
+
+//////////////////////////////////////////////////////////
+// A rate change while running goes on from the current position
+void rate()
+{
+    DmxSequence sequence("rate");
+    defineChase(sequence);
+    std::string error;
+    CHECK(sequence.compile(error));
+
+    uint8_t buffer[CHANNELS] = {};
+    buffer[1] = 40;
+    auto &track = sequence.tracks()[0];
+    sequence.start(2000, 0);
+    sequence.render(track, 2050, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 40 == buffer[1]);
+
+    sequence.setRate(2050, 2.0, true);
+    sequence.render(track, 2050, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 40 == buffer[1]);
+
+    // Position 150, half way through the fade
+    sequence.render(track, 2100, buffer, CHANNELS);
+    CHECK(128 == buffer[0] && 148 == buffer[1]);
+
+    // Position 300, the second loop's first step
+    sequence.render(track, 2175, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 255 == buffer[1]);
+
+    // Shifting the origin moves the position with the play-head
+    sequence.shift(100);
+    sequence.render(track, 2275, buffer, CHANNELS);
+    CHECK(255 == buffer[0] && 255 == buffer[1]);
+}
+
+} // namespace
+
+int main()
+{
+    compileErrors();
+    tracks();
+    steps();
+    loops();
+    rate();
+    std::printf("dmxsequence_test: ok\n");
+    return EXIT_SUCCESS;
+}
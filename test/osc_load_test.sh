@@ -0,0 +1,83 @@
+#!/bin/sh
+# LICENSE TEXT
+#
+#     dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+#     play DMX cues with MTC sync. It also receives OSC commands to do
+#     some configurations dynamically.
+#     Copyright (C) 2020  Stage Lab & bTactic.
+#
+#     This program is free software: you can redistribute it and/or modify
+#     it under the terms of the GNU General Public License as published by
+#     the Free Software Foundation, either version 3 of the License, or
+#     (at your option) any later version.
+#
+#     This program is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU General Public License for more details.
+#
+#     You should have received a copy of the GNU General Public License
+#     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+# OSC ingest throughput harness. Starts a player with the null output backend
+# (no olad needed; a 'Midi Through' port still is, e.g. `modprobe
+# snd-seq-dummy`) and runs tools/dmxloadgen over a matrix of bundle shapes,
+# printing one result line per shape.
+#
+#   test/osc_load_test.sh [player_binary] [loadgen_binary]
+#
+# Environment: PORT (OSC port, 18000), BUNDLES (per shape, 20000),
+# RATE (bundles/s, 0 = flat out).
+
+PLAYER=${1:-./build/cuems-dmxplayer}
+LOADGEN=${2:-./build/dmxloadgen}
+PORT=${PORT:-18000}
+BUNDLES=${BUNDLES:-20000}
+RATE=${RATE:-0}
+
+"$PLAYER" --port "$PORT" --null-output --no-snapshot > /dev/null 2>&1 &
+PLAYER_PID=$!
+trap 'kill $PLAYER_PID 2> /dev/null' EXIT INT TERM
+
+# Wait until the player answers /stats
+i=0
+until "$LOADGEN" --port "$PORT" --bundles 1 --settle 0 > /dev/null 2>&1; do
+    i=$((i + 1))
+    if [ $i -ge 50 ] || ! kill -0 $PLAYER_PID 2> /dev/null; then
+        echo "player did not come up on port $PORT" >&2
+        exit 1
+    fi
+    sleep 0.2
+done
+
+status=0
+# universes channels spread_ms
+for shape in "1 1 0" "1 16 0" "1 512 0" "4 64 0" "16 32 0" "1 16 2000" "4 64 2000"; do
+    set -- $shape
+    "$LOADGEN" --port "$PORT" --bundles "$BUNDLES" --rate "$RATE" \
+        --universes "$1" --channels "$2" --spread "$3" --fade 0.5 || status=$?
+    # Let queued scenes and fades drain before the next shape
+    "$LOADGEN" --port "$PORT" --bundles 1 --settle 1000 > /dev/null 2>&1
+done
+
+# Channel encodings of a pixel-mapping look: /frame pairs vs /frame_range
+for encoding in pairs range blob; do
+    "$LOADGEN" --port "$PORT" --bundles "$BUNDLES" --rate "$RATE" \
+        --universes 4 --channels 512 --encoding "$encoding" --fade 0.5 || status=$?
+    "$LOADGEN" --port "$PORT" --bundles 1 --settle 1000 > /dev/null 2>&1
+done
+
+# Steady state: with every universe already active, render ticks must not
+# allocate. Checked only when the player reports render_allocs (built with
+# CUEMS_ALLOC_COUNTING=ON).
+allocs=$("$LOADGEN" --port "$PORT" --bundles "$BUNDLES" --rate "$RATE" \
+    --universes 4 --channels 64 --spread 0 --fade 0.5 | sed -n 's/^render_allocs=//p')
+if [ -n "$allocs" ]; then
+    echo "steady_state_render_allocs=$allocs"
+    if [ "$allocs" != "0" ]; then
+        echo "render loop allocated in steady state" >&2
+        status=3
+    fi
+fi
+
+exit $status
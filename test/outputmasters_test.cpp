@@ -0,0 +1,159 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems output masters test
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "../outputmasters.h"
+#include "testcheck.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr size_t CHANNELS = CuemsConstants::DMX_CHANNELS_PER_UNIVERSE;
+
+//////////////////////////////////////////////////////////
+void levels()
+{
+    CHECK(0 == OutputMasters::fromFloat(0.0f));
+    CHECK(0 == OutputMasters::fromFloat(-1.0f));
+    CHECK(0 == OutputMasters::fromFloat(std::nanf("")));
+    CHECK(OutputMasters::FULL / 2 == OutputMasters::fromFloat(0.5f));
+    CHECK(OutputMasters::FULL == OutputMasters::fromFloat(1.0f));
+    CHECK(OutputMasters::FULL == OutputMasters::fromFloat(2.0f));
+}
+
+//////////////////////////////////////////////////////////
+// The grand master scales every channel, rounding to nearest, and going
+// back to full gives the rendered values back exactly
+void grandMaster()
+{
+    OutputMasters masters;
+    uint8_t in[CHANNELS];
+    uint8_t out[CHANNELS];
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        in[i] = static_cast<uint8_t>(i);
+    }
+
+    CHECK(masters.isFull(1));
+    masters.apply(1, in, out, CHANNELS);
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        CHECK(in[i] == out[i]);
+    }
+
+    masters.setLevel(0, OutputMasters::fromFloat(0.5f), 0, 0);
+    CHECK(!masters.isFull(1));
+    masters.apply(1, in, out, CHANNELS);
+    CHECK(0 == out[0]);
+    CHECK(1 == out[1]);                 // 0.5 rounds up
+    CHECK(50 == out[100]);
+    CHECK(128 == out[255]);
+
+    masters.setLevel(0, 0, 0, 0);
+    masters.apply(1, in, out, CHANNELS);
+    CHECK(0 == out[255]);
+
+    masters.setLevel(0, OutputMasters::FULL, 0, 0);
+    CHECK(masters.isFull(1));
+    masters.apply(1, in, out, CHANNELS);
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        CHECK(in[i] == out[i]);
+    }
+}
+
+//////////////////////////////////////////////////////////
+// A submaster only dims the channels assigned to it, and multiplies with
+// the grand master
+void submasters()
+{
+    OutputMasters masters;
+    uint8_t in[CHANNELS];
+    uint8_t out[CHANNELS];
+    std::fill(in, in + CHANNELS, 200);
+
+    masters.assign(1, 5, 10, 10, true);
+    masters.setLevel(1, OutputMasters::fromFloat(0.5f), 0, 0);
+    CHECK(!masters.isFull(5));
+    CHECK(masters.isFull(6));
+    masters.apply(5, in, out, CHANNELS);
+    CHECK(200 == out[9]);
+    CHECK(100 == out[10]);
+    CHECK(100 == out[19]);
+    CHECK(200 == out[20]);
+
+    masters.setLevel(0, OutputMasters::fromFloat(0.5f), 0, 0);
+    masters.apply(5, in, out, CHANNELS);
+    CHECK(100 == out[9]);
+    CHECK(50 == out[10]);
+
+    // Unassigned channels follow the grand master only
+    masters.setLevel(0, OutputMasters::FULL, 0, 0);
+    masters.assign(1, 5, 10, 5, false);
+    masters.apply(5, in, out, CHANNELS);
+    CHECK(200 == out[10]);
+    CHECK(100 == out[15]);
+
+    masters.assign(1, 5, 15, 5, false);
+    CHECK(masters.isFull(5));
+}
+
+//////////////////////////////////////////////////////////
+// Fades run on the clock given to update(), from wherever the level is
+void fades()
+{
+    OutputMasters masters;
+    masters.setLevel(0, 0, 1000000, 0);
+    CHECK(masters.fading());
+    CHECK(OutputMasters::FULL == masters.level(0));
+
+    CHECK(masters.update(500000));
+    CHECK(OutputMasters::FULL / 2 == masters.level(0));
+
+    // A new level while fading starts from the current one
+    masters.setLevel(0, OutputMasters::FULL, 500000, 500000);
+    CHECK(masters.update(750000));
+    CHECK(3 * OutputMasters::FULL / 4 == masters.level(0));
+
+    CHECK(masters.update(2000000));
+    CHECK(OutputMasters::FULL == masters.level(0));
+    CHECK(!masters.fading());
+    CHECK(!masters.update(3000000));
+}
+
+} // namespace
+
+int main()
+{
+    levels();
+    grandMaster();
+    submasters();
+    fades();
+    std::printf("outputmasters_test: ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems persistent output snapshot test
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "../outputsnapshot.h"
+#include "../cuemslogger/cuemslogger.h"
+#include "testcheck.h"
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t MAX = CuemsConstants::SNAPSHOT_MAX_UNIVERSES;
+
+bool publishValue(OutputSnapshot &snapshot, uint32_t id, uint8_t value)
+{
+    uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE];
+    std::memset(values, value, sizeof(values));
+    return snapshot.publish(id, 1000 + id, values, sizeof(values),
+                            [](OutputSnapshot::Transition *, size_t) { return size_t(0); });
+}
+
+const OutputSnapshot::Universe *find(const std::vector<OutputSnapshot::Universe> &universes, uint32_t id)
+{
+    for (const auto &u : universes) {
+        if (u.id == id) {
+            return &u;
+        }
+    }
+    return nullptr;
+}
+
+//////////////////////////////////////////////////////////
+// A player killed in the middle of publishing a universe: that universe is
+// not restored, the others are, and the slot is written cleanly afterwards
+void tornSlot(const std::string &path)
+{
+    pid_t pid = fork();
+    CHECK(0 <= pid);
+    if (0 == pid) {
+        OutputSnapshot snapshot;
+        if (!snapshot.open(path)) {
+            _exit(EXIT_FAILURE);
+        }
+        publishValue(snapshot, 1, 10);
+        publishValue(snapshot, 2, 20);
+        uint8_t values[CuemsConstants::DMX_CHANNELS_PER_UNIVERSE] = {};
+        snapshot.publish(2, 0, values, sizeof(values), [](OutputSnapshot::Transition *, size_t) -> size_t {
+            _exit(EXIT_SUCCESS);        // dies with the slot half written
+        });
+        _exit(EXIT_FAILURE);
+    }
+    int status = 0;
+    CHECK(pid == waitpid(pid, &status, 0));
+    CHECK(WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status));
+
+    OutputSnapshot snapshot;
+    CHECK(snapshot.open(path));
+    auto universes = snapshot.restore();
+    CHECK(1 == universes.size());
+    CHECK(find(universes, 1) != nullptr && 10 == find(universes, 1)->values[0]);
+    CHECK(1001 == find(universes, 1)->head);
+
+    publishValue(snapshot, 2, 30);
+    snapshot.close();
+    CHECK(snapshot.open(path));
+    universes = snapshot.restore();
+    CHECK(2 == universes.size());
+    CHECK(find(universes, 2) != nullptr && 30 == find(universes, 2)->values[0]);
+}
+
+//////////////////////////////////////////////////////////
+// Retired universes give their slot up, the one released longest ago
+// first, and slots of the previous run before those
+void slotReuse(const std::string &path)
+{
+    OutputSnapshot snapshot;
+    CHECK(snapshot.open(path));
+    for (uint32_t id = 1; id <= MAX; ++id) {
+        CHECK(publishValue(snapshot, id, 1));
+    }
+    CHECK(!publishValue(snapshot, 1000, 1));
+    CHECK(find(snapshot.restore(), 1000) == nullptr);
+
+    snapshot.release(3);
+    snapshot.release(5);
+    CHECK(publishValue(snapshot, 1000, 2));
+    auto universes = snapshot.restore();
+    CHECK(MAX == universes.size());
+    CHECK(find(universes, 3) == nullptr);
+    CHECK(find(universes, 5) != nullptr);
+    CHECK(find(universes, 1000) != nullptr && 2 == find(universes, 1000)->values[0]);
+
+    // A released universe that comes back takes its own slot again
+    CHECK(publishValue(snapshot, 5, 3));
+    CHECK(!publishValue(snapshot, 1001, 1));
+    CHECK(find(snapshot.restore(), 1001) == nullptr);
+
+    snapshot.close();
+    CHECK(snapshot.open(path));
+    publishValue(snapshot, 7, 4);
+    publishValue(snapshot, 1001, 4);
+    universes = snapshot.restore();
+    CHECK(MAX == universes.size());
+    CHECK(find(universes, 7) != nullptr && 4 == find(universes, 7)->values[0]);
+    CHECK(find(universes, 1001) != nullptr);
+}
+
+} // namespace
+
+int main()
+{
+    CuemsLogger logger("outputsnapshot_test");
+
+    char dir[] = "/tmp/cuems-snapshot-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    const std::string torn = std::string(dir) + "/torn.snapshot";
+    const std::string reuse = std::string(dir) + "/reuse.snapshot";
+
+    tornSlot(torn);
+    slotReuse(reuse);
+
+    unlink(torn.c_str());
+    unlink(reuse.c_str());
+    rmdir(dir);
+    std::printf("outputsnapshot_test: ok\n");
+    return EXIT_SUCCESS;
+}
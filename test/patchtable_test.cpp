@@ -0,0 +1,200 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems patch table test
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+#include "../patchtable.h"
+#include "testcheck.h"
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t CHANNELS = PatchTable::CHANNELS;
+
+std::string g_dir;
+
+//////////////////////////////////////////////////////////
+// Load a patch file with the given lines
+bool load(PatchTable &table, const std::string &text)
+{
+    const std::string path = g_dir + "/test.patch";
+    std::ofstream(path) << text;
+    bool loaded = table.load(path);
+    unlink(path.c_str());
+    return loaded;
+}
+
+bool loadFails(const std::string &text, const std::string &error)
+{
+    PatchTable table;
+    return !load(table, text) && std::string::npos != table.lastError().find(error);
+}
+
+//////////////////////////////////////////////////////////
+// Build a physical universe from the stored logical frames, as the player
+// does: sources side by side in the staging area, then one gather pass
+void build(const PatchTable &table, const PatchTable::Physical &phys, uint8_t *out)
+{
+    uint8_t staging[PatchTable::STAGING_SIZE] = {};
+    for (unsigned int s = 0; s < phys.sourceCount; ++s) {
+        std::memcpy(staging + s * CHANNELS, table.sourceFrame(phys.sources[s]), CHANNELS);
+    }
+    PatchTable::gather(phys, staging, out);
+}
+
+void storeValue(PatchTable &table, uint32_t universe, uint8_t value)
+{
+    uint8_t frame[CHANNELS];
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        frame[i] = static_cast<uint8_t>(value + i);
+    }
+    CHECK(table.storeFrame(universe, frame, CHANNELS));
+}
+
+//////////////////////////////////////////////////////////
+// Malformed lines are rejected with their line number
+void malformed()
+{
+    PatchTable table;
+    CHECK(!table.load(g_dir + "/missing.patch"));
+    CHECK(std::string::npos != table.lastError().find("cannot open"));
+
+    CHECK(loadFails("1 0 2 0\n1 x 2 0\n", ":2: bad logical"));
+    CHECK(loadFails("1 512 2 0\n", ":1: bad logical"));
+    CHECK(loadFails("-1 0 2 0\n", ":1: bad logical"));
+    CHECK(loadFails("65536 0 2 0\n", ":1: bad logical"));
+    CHECK(loadFails("1 0 2\n", ":1: bad physical"));
+    CHECK(loadFails("1 0 2 512\n", ":1: bad physical"));
+    CHECK(loadFails("1 0 2 0 3 -1\n", ":1: bad physical"));
+    CHECK(loadFails("1 0\n", ":1: expected"));
+    CHECK(loadFails("1 0 2 0 x\n", ":1: expected"));
+
+    // Comments and blank lines are skipped
+    CHECK(load(table, "# patch\n\n   \n1 0 2 0   # dimmer\n"));
+    CHECK(1 == table.entries());
+    CHECK(table.isLogical(1) && !table.isLogical(2));
+    CHECK(table.isPhysical(2) && !table.isPhysical(1));
+}
+
+//////////////////////////////////////////////////////////
+// One logical channel to several outputs, several logical universes into
+// one physical universe, and the later of two routes to a physical channel
+void routes()
+{
+    PatchTable table;
+    CHECK(load(table,
+        "1 0 10 0 11 3\n"       // fan-out
+        "2 5 10 1\n"            // fan-in
+        "1 1 10 2\n"
+        "2 6 10 2\n"));         // same physical channel: later wins
+    CHECK(5 == table.entries());         // one per output
+    CHECK(2 == table.physical().size());
+
+    storeValue(table, 1, 100);
+    storeValue(table, 2, 200);
+    CHECK(!table.storeFrame(3, table.sourceFrame(0), CHANNELS));
+
+    const PatchTable::Physical *p10 = table.findPhysical(10);
+    const PatchTable::Physical *p11 = table.findPhysical(11);
+    CHECK(p10 != nullptr && p11 != nullptr);
+    CHECK(2 == p10->sourceCount);
+    CHECK(1 == p11->sourceCount);
+    CHECK(p10->dirty && p11->dirty);
+
+    uint8_t out[CHANNELS];
+    build(table, *p10, out);
+    CHECK(100 == out[0]);
+    CHECK(205 == out[1]);
+    CHECK(206 == out[2]);
+    CHECK(0 == out[3]);                 // unpatched
+    CHECK(0 == out[CHANNELS - 1]);
+
+    build(table, *p11, out);
+    CHECK(100 == out[3]);
+    CHECK(0 == out[0]);
+}
+
+//////////////////////////////////////////////////////////
+void tooManySources()
+{
+    std::string text;
+    for (unsigned int u = 1; u <= CuemsConstants::PATCH_MAX_SOURCES; ++u) {
+        text += std::to_string(u) + " 0 100 " + std::to_string(u) + "\n";
+    }
+    PatchTable table;
+    CHECK(load(table, text));
+    CHECK(CuemsConstants::PATCH_MAX_SOURCES == table.findPhysical(100)->sourceCount);
+
+    text += "99 0 100 0\n";
+    CHECK(loadFails(text, "fed by more than"));
+}
+
+//////////////////////////////////////////////////////////
+// A reloaded table keeps the frames the old one knew
+void reload()
+{
+    PatchTable before;
+    CHECK(load(before, "1 0 10 0\n2 0 11 0\n"));
+    storeValue(before, 1, 42);
+
+    PatchTable after;
+    CHECK(load(after, "1 0 12 7\n3 0 12 0\n"));
+    after.adopt(before);
+    CHECK(after.frame(1) != nullptr && 42 == after.frame(1)[0]);
+    CHECK(after.frame(3) == nullptr);
+
+    uint8_t out[CHANNELS];
+    build(after, *after.findPhysical(12), out);
+    CHECK(after.findPhysical(12)->dirty);
+    CHECK(42 == out[7]);
+
+    after.blackout();
+    build(after, *after.findPhysical(12), out);
+    CHECK(0 == out[7]);
+}
+
+} // namespace
+
+int main()
+{
+    char dir[] = "/tmp/cuems-patch-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    g_dir = dir;
+
+    malformed();
+    routes();
+    tooManySources();
+    reload();
+
+    rmdir(dir);
+    std::printf("patchtable_test: ok\n");
+    return EXIT_SUCCESS;
+}
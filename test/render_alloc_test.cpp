@@ -0,0 +1,184 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems render tick heap allocation test
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+// Drives the render tick of a player on the null output backend with
+// fading universes, effects, the output snapshot and a steady stream of new
+// scenes (one for a universe not seen before, which then gets a rate cap of
+// its own while the grand master fades), and checks that once warmed
+// up the ticks make no heap allocation. Built with CUEMS_ALLOC_COUNTING,
+// like the player for test/osc_load_test.sh. The player opens no MTC port,
+// so the test needs no MIDI hardware.
+
+#include "../dmxplayer.h"
+#include "../allocprobe.h"
+#include "../cuemslogger/cuemslogger.h"
+#include "testcheck.h"
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <ola/Clock.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+static_assert(AllocProbe::enabled, "render_alloc_test must be built with CUEMS_ALLOC_COUNTING");
+
+namespace {
+
+constexpr int UNIVERSES = 4;
+constexpr int WARMUP_TICKS = 50;
+constexpr int MEASURED_TICKS = 250;
+constexpr int SCENE_EVERY_TICKS = 10;
+
+int *volatile g_sink = nullptr;
+
+//////////////////////////////////////////////////////////
+class RenderAllocTest : public DmxPlayer
+{
+    public:
+        // Batched receiver on an ephemeral port (bundles are fed in
+        // directly) and no MTC input: scenes run on the internal clock
+        RenderAllocTest()
+            : DmxPlayer(0, "", true, false, "render_alloc_test", true,
+                        CuemsConstants::OSC_RCVBUF_DEFAULT, false) {}
+
+        int run(const std::string &snapshotPath);
+
+    private:
+        void sendScene(int universe, int value);
+        void sendMaster(float level, float fade);
+        void tick();
+
+        char m_packet[16 * 1024];
+};
+
+//////////////////////////////////////////////////////////
+// A full universe fading to value over 5 s, with an effect on its first
+// channels that replaces the one the previous scene started
+void RenderAllocTest::sendScene(int universe, int value)
+{
+    osc::OutboundPacketStream p(m_packet, sizeof(m_packet));
+    p << osc::BeginBundleImmediate
+      << osc::BeginMessage("/frame") << osc::int32(universe);
+    for (int channel = 0; channel < CuemsConstants::DMX_CHANNELS_PER_UNIVERSE; ++channel) {
+        p << osc::int32(channel) << osc::int32(value);
+    }
+    p << osc::EndMessage
+      << osc::BeginMessage("/fade_time") << 5.0f << osc::EndMessage
+      << osc::BeginMessage("/effect") << osc::int32(universe) << osc::int32(0) << osc::int32(16)
+      << "sine" << 1.0f << 1.0f << osc::int32(100) << osc::int32(50) << osc::EndMessage
+      << osc::EndBundle;
+
+    osc::ReceivedPacket packet(p.Data(), p.Size());
+    ProcessBundle(osc::ReceivedBundle(packet), IpEndpointName());
+}
+
+//////////////////////////////////////////////////////////
+void RenderAllocTest::sendMaster(float level, float fade)
+{
+    osc::OutboundPacketStream p(m_packet, sizeof(m_packet));
+    p << osc::BeginMessage("/master") << level << fade << osc::EndMessage;
+
+    osc::ReceivedPacket packet(p.Data(), p.Size());
+    ProcessMessage(osc::ReceivedMessage(packet), IpEndpointName());
+}
+
+//////////////////////////////////////////////////////////
+// One render tick, then one pass of the output (I/O) thread's work:
+// queued frames and fetches, and the null backend's fetch replies
+void RenderAllocTest::tick()
+{
+    renderTick();
+    olaServer->RunOnce(ola::TimeInterval(0, 0));
+}
+
+//////////////////////////////////////////////////////////
+int RenderAllocTest::run(const std::string &snapshotPath)
+{
+    setNullOutput(true);
+    CHECK(setSnapshotFile(snapshotPath));
+    CHECK(setupOlaConnection());
+
+    for (int universe = 1; universe <= UNIVERSES; ++universe) {
+        sendScene(universe, 100);
+    }
+    for (int k = 0; k < WARMUP_TICKS; ++k) {
+        tick();
+    }
+    CHECK(UNIVERSES == m_activeUniverses.size());
+
+    uint64_t allocs = m_renderAllocs.load();
+    uint64_t allocTicks = m_renderAllocTicks.load();
+    for (int k = 0; k < MEASURED_TICKS; ++k) {
+        if (MEASURED_TICKS / 2 == k) {
+            sendScene(UNIVERSES + 1, 200);
+        }
+        else if (MEASURED_TICKS / 2 + 1 == k) {
+            setOutputFpsCap(static_cast<uint32_t>(UNIVERSES + 1), 30);
+            sendMaster(0.5f, 1.0f);
+        }
+        else if (0 == k % SCENE_EVERY_TICKS) {
+            sendScene(1 + k / SCENE_EVERY_TICKS % UNIVERSES, k % 256);
+        }
+        tick();
+    }
+    allocs = m_renderAllocs.load() - allocs;
+    allocTicks = m_renderAllocTicks.load() - allocTicks;
+
+    std::printf("render_alloc_test: %d ticks, %llu heap allocations in %llu of them\n", MEASURED_TICKS,
+                static_cast<unsigned long long>(allocs), static_cast<unsigned long long>(allocTicks));
+    CHECK(UNIVERSES + 1 == m_activeUniverses.size());
+    CHECK(0 == allocs);
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main()
+{
+    CuemsLogger logger("render_alloc_test");
+
+    // The probe itself counts what this thread allocates
+    AllocProbe::begin();
+    g_sink = new int(0);
+    CHECK(1 == AllocProbe::end());
+    delete g_sink;
+
+    auto player = std::make_unique<RenderAllocTest>();
+
+    char dir[] = "/tmp/cuems-render-alloc-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    const std::string snapshotPath = std::string(dir) + "/render.snapshot";
+    int result = player->run(snapshotPath);
+    player.reset();
+    unlink(snapshotPath.c_str());
+    rmdir(dir);
+    return result;
+}
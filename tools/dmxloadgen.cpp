@@ -0,0 +1,292 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX player OSC load generator
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//
+// Blasts scene bundles of a configurable shape at a running player over
+// UDP and reports, from the player's /stats replies taken before and after
+// the run, how many bundles it accepted and what they cost:
+//
+//   dmxloadgen --port 8000 --bundles 20000 --rate 0 --universes 4 --channels 64
+//
+// Best run against a player started with --null-output, so olad is neither
+// needed nor part of the measurement. Results are printed as one line of
+// key=value pairs so test/osc_load_test.sh can tabulate several shapes;
+// the exit status is 2 when bundles were lost.
+
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Largest UDP payload over IPv4
+constexpr size_t MAX_DATAGRAM = 65507;
+constexpr int STATS_TIMEOUT_MS = 2000;
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    int port = 8000;
+    long bundles = 10000;
+    double rate = 0;            // Bundles/s, 0 = as fast as possible
+    int universes = 1;          // /frame messages per bundle
+    int firstUniverse = 1;
+    int channels = 16;          // Channels per universe
+    std::string encoding = "pairs";   // pairs: /frame, range: /frame_range ints, blob: /frame_range blob
+    int spreadMs = 0;           // /start_offset drawn from [0, spreadMs]
+    float fade = 1.0f;          // /fade_time, seconds
+    int settleMs = 500;         // Wait before the final /stats
+    unsigned int seed = 1;
+};
+
+using Stats = std::map<std::string, double>;
+
+//////////////////////////////////////////////////////////
+void usage()
+{
+    std::printf(
+        "Usage: dmxloadgen [options]\n"
+        "  --host <addr>          player address (127.0.0.1)\n"
+        "  --port <port>          player OSC port (8000)\n"
+        "  --bundles <n>          bundles to send (10000)\n"
+        "  --rate <n>             bundles/s, 0 = as fast as possible (0)\n"
+        "  --universes <n>        /frame messages per bundle (1)\n"
+        "  --first-universe <n>   first universe id (1)\n"
+        "  --channels <n>         channels per /frame, 1-512 (16)\n"
+        "  --encoding <e>         pairs (/frame), range (/frame_range ints),\n"
+        "                         blob (/frame_range blob) (pairs)\n"
+        "  --spread <ms>          spread start times over [0, ms] (0 = now)\n"
+        "  --fade <s>             fade time (1.0)\n"
+        "  --settle <ms>          wait before the final /stats (500)\n"
+        "  --seed <n>             start time spread seed (1)\n");
+}
+
+//////////////////////////////////////////////////////////
+bool parseOptions(int argc, char *argv[], Options &o)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *val = argv[++i];
+        if ("--host" == arg) o.host = val;
+        else if ("--port" == arg) o.port = std::atoi(val);
+        else if ("--bundles" == arg) o.bundles = std::atol(val);
+        else if ("--rate" == arg) o.rate = std::atof(val);
+        else if ("--universes" == arg) o.universes = std::atoi(val);
+        else if ("--first-universe" == arg) o.firstUniverse = std::atoi(val);
+        else if ("--channels" == arg) o.channels = std::atoi(val);
+        else if ("--encoding" == arg) o.encoding = val;
+        else if ("--spread" == arg) o.spreadMs = std::atoi(val);
+        else if ("--fade" == arg) o.fade = std::atof(val);
+        else if ("--settle" == arg) o.settleMs = std::atoi(val);
+        else if ("--seed" == arg) o.seed = std::atoi(val);
+        else return false;
+    }
+    return o.port > 0 && o.bundles > 0 && o.universes > 0
+        && o.channels > 0 && o.channels <= 512 && o.spreadMs >= 0
+        && ("pairs" == o.encoding || "range" == o.encoding || "blob" == o.encoding);
+}
+
+//////////////////////////////////////////////////////////
+// Ask the player for /stats and parse its key, value reply
+bool queryStats(int fd, const sockaddr_in &to, Stats &stats)
+{
+    char buffer[256];
+    osc::OutboundPacketStream p(buffer, sizeof(buffer));
+    p << osc::BeginMessage("/stats") << osc::EndMessage;
+    if (sendto(fd, p.Data(), p.Size(), 0, reinterpret_cast<const sockaddr *>(&to), sizeof(to)) < 0) {
+        return false;
+    }
+
+    static char reply[MAX_DATAGRAM];
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, STATS_TIMEOUT_MS) <= 0) {
+        return false;
+    }
+    ssize_t n = recv(fd, reply, sizeof(reply), 0);
+    if (n <= 0) {
+        return false;
+    }
+
+    try {
+        osc::ReceivedPacket packet(reply, n);
+        if (!packet.IsMessage()) {
+            return false;
+        }
+        osc::ReceivedMessage m(packet);
+        stats.clear();
+        for (auto it = m.ArgumentsBegin(); it != m.ArgumentsEnd(); ++it) {
+            std::string key = (it++)->AsString();
+            if (it == m.ArgumentsEnd()) break;
+            if (it->IsInt64()) stats[key] = static_cast<double>(it->AsInt64());
+            else if (it->IsDouble()) stats[key] = it->AsDouble();
+            else if (it->IsInt32()) stats[key] = it->AsInt32();
+            else if (it->IsFloat()) stats[key] = it->AsFloat();
+        }
+    } catch (const osc::Exception &e) {
+        std::fprintf(stderr, "bad /stats reply: %s\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////
+size_t buildBundle(const Options &o, long index, int offsetMs, char *buffer)
+{
+    osc::OutboundPacketStream p(buffer, MAX_DATAGRAM);
+    p << osc::BeginBundleImmediate;
+    for (int u = 0; u < o.universes; ++u) {
+        if ("pairs" == o.encoding) {
+            p << osc::BeginMessage("/frame") << static_cast<osc::int32>(o.firstUniverse + u);
+            for (int ch = 0; ch < o.channels; ++ch) {
+                p << static_cast<osc::int32>(ch) << static_cast<osc::int32>((index * 7 + ch) & 0xff);
+            }
+        } else {
+            p << osc::BeginMessage("/frame_range") << static_cast<osc::int32>(o.firstUniverse + u)
+              << static_cast<osc::int32>(0);
+            if ("blob" == o.encoding) {
+                char values[512];
+                for (int ch = 0; ch < o.channels; ++ch) {
+                    values[ch] = static_cast<char>((index * 7 + ch) & 0xff);
+                }
+                p << osc::Blob(values, o.channels);
+            } else {
+                for (int ch = 0; ch < o.channels; ++ch) {
+                    p << static_cast<osc::int32>((index * 7 + ch) & 0xff);
+                }
+            }
+        }
+        p << osc::EndMessage;
+    }
+    p << osc::BeginMessage("/fade_time") << o.fade << osc::EndMessage;
+    if (0 < offsetMs) {
+        p << osc::BeginMessage("/start_offset") << static_cast<osc::int32>(offsetMs) << osc::EndMessage;
+    }
+    p << osc::EndBundle;
+    return p.Size();
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+    Options o;
+    if (!parseOptions(argc, argv, o)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(o.port);
+    if (fd < 0 || 1 != inet_pton(AF_INET, o.host.c_str(), &to.sin_addr)) {
+        std::fprintf(stderr, "cannot open socket to %s\n", o.host.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Baseline; also opens a fresh tick lateness window on the player
+    Stats before, after;
+    if (!queryStats(fd, to, before)) {
+        std::fprintf(stderr, "no /stats reply from %s:%d\n", o.host.c_str(), o.port);
+        return EXIT_FAILURE;
+    }
+
+    static char buffer[MAX_DATAGRAM];
+    std::mt19937 rng(o.seed);
+    std::uniform_int_distribution<int> spread(0, o.spreadMs);
+    long sendErrors = 0;
+    size_t bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < o.bundles; ++i) {
+        if (0 < o.rate) {
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(i / o.rate));
+        }
+        size_t size = 0;
+        try {
+            size = buildBundle(o, i, o.spreadMs ? spread(rng) : 0, buffer);
+        } catch (const osc::Exception &) {
+            std::fprintf(stderr, "bundle shape does not fit in one datagram\n");
+            return EXIT_FAILURE;
+        }
+        if (sendto(fd, buffer, size, 0, reinterpret_cast<const sockaddr *>(&to), sizeof(to)) < 0) {
+            ++sendErrors;
+        }
+        bytes += size;
+    }
+    double sendS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(o.settleMs));
+    if (!queryStats(fd, to, after)) {
+        std::fprintf(stderr, "no final /stats reply\n");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    auto delta = [&](const char *key) { return after[key] - before[key]; };
+    long sent = o.bundles - sendErrors;
+    long accepted = static_cast<long>(delta("ingest_bundles"));
+    long lost = sent - accepted;
+    double ingestCpuMs = delta("ingest_cpu_ms");
+
+    std::printf("universes=%d channels=%d encoding=%s spread_ms=%d bundle_bytes=%zu"
+                " sent=%ld send_errors=%ld send_rate=%.0f"
+                " accepted=%ld lost=%ld loss_pct=%.2f kernel_drops=%.0f"
+                " ingest_cpu_ms=%.1f ingest_us_per_bundle=%.2f"
+                " render_cpu_ms=%.1f frames_sent=%.0f ticks=%.0f"
+                " tick_late_avg_ms=%.3f tick_late_max_ms=%.3f\n",
+                o.universes, o.channels, o.encoding.c_str(), o.spreadMs, bytes / o.bundles,
+                sent, sendErrors, sent / sendS,
+                accepted, lost, sent ? 100.0 * lost / sent : 0.0, delta("udp_kernel_drops"),
+                ingestCpuMs, accepted ? 1000.0 * ingestCpuMs / accepted : 0.0,
+                delta("render_cpu_ms"), delta("frames_sent"), after["ticks"],
+                after["tick_late_avg_ms"], after["tick_late_max_ms"]);
+    // Only reported by players built with CUEMS_ALLOC_COUNTING
+    if (after.count("render_allocs") != 0) {
+        std::printf("render_allocs=%.0f\n", delta("render_allocs"));
+    }
+    return lost > 0 ? 2 : EXIT_SUCCESS;
+}
@@ -0,0 +1,315 @@
+/* LICENSE TEXT
+
+    dmxplayer for linux based on OLA, RtMidi and oscpack libraries to
+    play DMX cues with MTC sync. It also receives OSC commands to do
+    some configurations dynamically.
+    Copyright (C) 2020  Stage Lab & bTactic.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Stage Lab Cuems DMX player show trace replay tool
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+//
+// Feeds a show trace recorded by a player (--trace-file) back through a
+// player started with --replay, under the trace's clock:
+//
+//   cuems-dmxplayer --port 8100 --replay --null-output &
+//   dmxreplay --trace /dev/shm/cuems-dmxplayer-8000.trace.prev --port 8100
+//
+// OSC packets are re-sent as they were received; every recorded render tick
+// becomes a /replay_tick carrying its play-head and time, and the tool waits
+// for it to finish before going on, so the player sees packets and ticks in
+// the recorded order. The frames each tick sends are compared, by hash,
+// with the frames recorded for it.
+//
+// By default the trace is replayed as fast as the player goes (a benchmark
+// of real show traffic); --realtime keeps the recorded pacing. Results are
+// printed as one line of key=value pairs; the exit status is 2 when any
+// tick sent different frames than recorded.
+//
+// Universes the recorded player fetched from olad start blacked out under
+// --null-output, so shows that build on a look set by another source may
+// report mismatches on their first fades.
+
+#include "../showtrace.h"
+#include <oscpack/osc/OscOutboundPacketStream.h>
+#include <oscpack/osc/OscReceivedElements.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Largest UDP payload over IPv4
+constexpr size_t MAX_DATAGRAM = 65507;
+constexpr int REPLY_TIMEOUT_MS = 2000;
+
+struct Options
+{
+    std::string trace;
+    std::string host = "127.0.0.1";
+    int port = 8000;
+    bool realtime = false;      // Keep the recorded pacing
+};
+
+struct Totals
+{
+    long packets = 0;
+    long sendErrors = 0;
+    long ticks = 0;
+    long renderedTicks = 0;
+    long frames = 0;
+    long mismatches = 0;
+    int64_t firstMismatchMs = -1;   // Into the trace
+    bool failed = false;
+};
+
+//////////////////////////////////////////////////////////
+void usage()
+{
+    std::printf(
+        "Usage: dmxreplay --trace <file> [options]\n"
+        "  --trace <file>         show trace recorded by the player\n"
+        "  --host <addr>          player address (127.0.0.1)\n"
+        "  --port <port>          OSC port of a player started with --replay (8000)\n"
+        "  --realtime             keep the recorded pacing (default: as fast as possible)\n");
+}
+
+//////////////////////////////////////////////////////////
+bool parseOptions(int argc, char *argv[], Options &o)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ("--realtime" == arg) {
+            o.realtime = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char *val = argv[++i];
+        if ("--trace" == arg) o.trace = val;
+        else if ("--host" == arg) o.host = val;
+        else if ("--port" == arg) o.port = std::atoi(val);
+        else return false;
+    }
+    return !o.trace.empty() && o.port > 0;
+}
+
+//////////////////////////////////////////////////////////
+// Run one tick on the player and read back the frames it sent. Replies to
+// replayed queries (/stats, /get_state) arrive on the same socket and are
+// skipped.
+bool replayTick(int fd, const sockaddr_in &to, const ShowTrace::TickInfo &tick, int64_t timeUs,
+                int32_t &frames, uint64_t &hash)
+{
+    char buffer[256];
+    osc::OutboundPacketStream p(buffer, sizeof(buffer));
+    p << osc::BeginMessage("/replay_tick")
+      << static_cast<osc::int64>(tick.playHead)
+      << static_cast<osc::int64>(timeUs)
+      << static_cast<osc::int32>(tick.rendered)
+      << osc::EndMessage;
+    if (sendto(fd, p.Data(), p.Size(), 0, reinterpret_cast<const sockaddr *>(&to), sizeof(to)) < 0) {
+        return false;
+    }
+
+    static char reply[MAX_DATAGRAM];
+    static const std::string suffix = "/replay_tick";
+    for (;;) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, REPLY_TIMEOUT_MS) <= 0) {
+            return false;
+        }
+        ssize_t n = recv(fd, reply, sizeof(reply), 0);
+        if (n <= 0) {
+            return false;
+        }
+        try {
+            osc::ReceivedPacket packet(reply, n);
+            if (!packet.IsMessage()) {
+                continue;
+            }
+            osc::ReceivedMessage m(packet);
+            std::string address = m.AddressPattern();
+            if (address.size() < suffix.size()
+                || 0 != address.compare(address.size() - suffix.size(), suffix.size(), suffix)) {
+                continue;
+            }
+            osc::int32 count = 0;
+            osc::int64 value = 0;
+            m.ArgumentStream() >> count >> value >> osc::EndMessage;
+            frames = count;
+            hash = static_cast<uint64_t>(value);
+            return true;
+        } catch (const osc::Exception &e) {
+            std::fprintf(stderr, "bad /replay_tick reply: %s\n", e.what());
+            return false;
+        }
+    }
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+    Options o;
+    if (!parseOptions(argc, argv, o)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in to{};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(o.port);
+    if (fd < 0 || 1 != inet_pton(AF_INET, o.host.c_str(), &to.sin_addr)) {
+        std::fprintf(stderr, "cannot open socket to %s\n", o.host.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Packets are stamped with the play-head of the latest tick: start the
+    // player at the first recorded one, without rendering
+    ShowTrace::TickInfo prime{};
+    int64_t primeUs = 0;
+    bool primed = false;
+    bool readOk = ShowTrace::read(o.trace, [&](const ShowTrace::Record &rec) {
+        if (!primed && ShowTrace::Type::Tick == rec.type && sizeof(prime) <= rec.size) {
+            std::memcpy(&prime, rec.data, sizeof(prime));
+            primeUs = rec.timeUs;
+            primed = true;
+        }
+    });
+    if (!readOk) {
+        std::fprintf(stderr, "cannot read trace %s\n", o.trace.c_str());
+        return EXIT_FAILURE;
+    }
+    int32_t primeFrames = 0;
+    uint64_t primeHash = 0;
+    prime.rendered = 0;
+    if (primed && !replayTick(fd, to, prime, primeUs, primeFrames, primeHash)) {
+        std::fprintf(stderr, "no /replay_tick reply from %s:%d (is it running with --replay?)\n",
+                     o.host.c_str(), o.port);
+        return EXIT_FAILURE;
+    }
+
+    Totals totals;
+    int64_t firstUs = 0;
+    int64_t lastUs = 0;
+    bool started = false;
+    int32_t recordedFrames = 0;                 // Frames recorded since the last tick
+    uint64_t recordedHash = ShowTrace::FRAME_HASH_SEED;
+    auto start = std::chrono::steady_clock::now();
+
+    readOk = ShowTrace::read(o.trace, [&](const ShowTrace::Record &rec) {
+        if (totals.failed) {
+            return;
+        }
+        if (!started) {
+            firstUs = rec.timeUs;
+            started = true;
+        }
+        lastUs = rec.timeUs;
+        if (o.realtime) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(rec.timeUs - firstUs));
+        }
+
+        switch (rec.type) {
+            case ShowTrace::Type::Packet:
+                if (sendto(fd, rec.data, rec.size, 0, reinterpret_cast<const sockaddr *>(&to), sizeof(to)) < 0) {
+                    ++totals.sendErrors;
+                }
+                ++totals.packets;
+                break;
+
+            case ShowTrace::Type::Frame: {
+                uint32_t universe = 0;
+                if (rec.size < sizeof(universe)) {
+                    break;
+                }
+                std::memcpy(&universe, rec.data, sizeof(universe));
+                recordedHash = ShowTrace::frameHash(recordedHash, universe,
+                    rec.data + sizeof(universe), rec.size - sizeof(universe));
+                ++recordedFrames;
+                break;
+            }
+
+            case ShowTrace::Type::Tick: {
+                ShowTrace::TickInfo tick{};
+                if (rec.size < sizeof(tick)) {
+                    break;
+                }
+                std::memcpy(&tick, rec.data, sizeof(tick));
+                int32_t frames = 0;
+                uint64_t hash = 0;
+                if (!replayTick(fd, to, tick, rec.timeUs, frames, hash)) {
+                    std::fprintf(stderr, "no /replay_tick reply from %s:%d (is it running with --replay?)\n",
+                                 o.host.c_str(), o.port);
+                    totals.failed = true;
+                    return;
+                }
+                ++totals.ticks;
+                totals.renderedTicks += tick.rendered ? 1 : 0;
+                totals.frames += frames;
+                if (frames != recordedFrames || hash != recordedHash) {
+                    if (0 == totals.mismatches) {
+                        totals.firstMismatchMs = (rec.timeUs - firstUs) / 1000;
+                    }
+                    ++totals.mismatches;
+                }
+                recordedFrames = 0;
+                recordedHash = ShowTrace::FRAME_HASH_SEED;
+                break;
+            }
+
+            default:
+                break;
+        }
+    });
+    close(fd);
+
+    if (!readOk) {
+        std::fprintf(stderr, "cannot read trace %s\n", o.trace.c_str());
+        return EXIT_FAILURE;
+    }
+    if (totals.failed) {
+        return EXIT_FAILURE;
+    }
+
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double traceS = (lastUs - firstUs) / 1e6;
+    std::printf("packets=%ld send_errors=%ld ticks=%ld rendered_ticks=%ld frames=%ld"
+                " mismatched_ticks=%ld first_mismatch_ms=%lld"
+                " trace_s=%.3f wall_s=%.3f speedup=%.1f ticks_per_s=%.0f\n",
+                totals.packets, totals.sendErrors, totals.ticks, totals.renderedTicks, totals.frames,
+                totals.mismatches, static_cast<long long>(totals.firstMismatchMs),
+                traceS, wallS, wallS > 0 ? traceS / wallS : 0.0, wallS > 0 ? totals.ticks / wallS : 0.0);
+    return totals.mismatches > 0 ? 2 : EXIT_SUCCESS;
+}